@@ -0,0 +1,166 @@
+#pragma once
+
+#ifdef _MSC_VER
+#include <xmmintrin.h>
+#endif
+#include "glm/mat4x4.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include "Entity.h"
+
+// ––––– AI POLICIES ––––– //
+// Each AIType's behaviour is a specialisation of AIPolicy with one static
+// think() that reads the tick's Perception and sets the enemy's movement and
+// state. The world buckets awake enemies by type and runs each bucket through
+// Entity::begin_update<TYPE>, so every enemy in a loop takes the same path
+// and think() is inlined straight into it; no switch on the type, and the
+// switch on the state sees the same handful of cases over and over.
+//
+// Policies that chase set FOLLOWS_FLOW, and only their perceptions get the
+// flow field sampled into them.
+//
+// Adding a type: add it to AIType before AI_TYPE_COUNT and specialise
+// AIPolicy for it here. The world's buckets and Entity::ai_activate's table
+// are both built from AI_TYPE_COUNT.
+
+// Which way to chase the player: the flow field's step where there is one,
+// otherwise straight at them along x, as the chasers always used to
+inline float chase_direction(const Perception& perception)
+{
+    if (perception.flow_x != 0.0f) return perception.flow_x;
+    return perception.offset_x > 0.0f ? -1.0f : 1.0f;
+}
+
+// How many enemies ahead of itself a bucket loop asks for
+#define AI_PREFETCH_DISTANCE 8
+
+// A bucket has its enemies in whatever order they went live in, not memory
+// order, so the hardware can't see which entity is coming next. Loops over
+// one call this for the enemy AI_PREFETCH_DISTANCE on, which starts loading
+// both cache lines begin_update can touch (see Entity) while the ones before
+// it think.
+inline void prefetch_for_ai(const Entity& enemy)
+{
+    const char* first = reinterpret_cast<const char*>(&enemy);
+    const char* last  = reinterpret_cast<const char*>(&enemy.m_animation_clip);
+#ifdef _MSC_VER
+    _mm_prefetch(first, _MM_HINT_T0);
+    _mm_prefetch(last,  _MM_HINT_T0);
+#else
+    __builtin_prefetch(first);
+    __builtin_prefetch(last);
+#endif
+}
+
+// Walks left forever
+template <>
+struct AIPolicy<WALKER>
+{
+    static const bool FOLLOWS_FLOW = false;
+
+    static void think(Entity& enemy, const Perception&)
+    {
+        enemy.m_movement = glm::vec3(-1.0f, 0.0f, 0.0f);
+    };
+};
+
+// Stands still until the player comes within 3, then follows them
+template <>
+struct AIPolicy<GUARD>
+{
+    static const bool FOLLOWS_FLOW = true;
+
+    static void think(Entity& enemy, const Perception& perception)
+    {
+        switch (enemy.m_ai_state) {
+        case IDLE:
+            if (perception.distance_squared < 3.0f * 3.0f) enemy.m_ai_state = WALKING;
+            break;
+
+        case WALKING:
+            enemy.m_movement = glm::vec3(chase_direction(perception), 0.0f, 0.0f);
+            break;
+
+        default:
+            break;
+        }
+    };
+};
+
+// Jumps again as soon as it lands
+template <>
+struct AIPolicy<JUMPER>
+{
+    static const bool FOLLOWS_FLOW = false;
+
+    static void think(Entity& enemy, const Perception&)
+    {
+        if (!enemy.m_is_jumping) {
+            enemy.m_bodies->velocity_y[enemy.m_body] = enemy.m_jumping_power;
+            enemy.m_is_jumping = true;
+        }
+    };
+};
+
+// Runs away from the player while they're within 1.5, once they've come
+// within 2
+template <>
+struct AIPolicy<RUNNER>
+{
+    static const bool FOLLOWS_FLOW = false;
+
+    static void think(Entity& enemy, const Perception& perception)
+    {
+        switch (enemy.m_ai_state) {
+        case IDLE:
+            if (perception.distance_squared < 2.0f * 2.0f) enemy.m_ai_state = RUNNING;
+            break;
+
+        case RUNNING:
+            if (perception.distance_squared < 1.5f * 1.5f) enemy.m_movement = glm::vec3(perception.offset_x > 0.0f ? 2.0f : -2.0f, 0.0f, 0.0f);
+            else                                           enemy.set_ai_state(IDLE);
+            break;
+
+        default:
+            break;
+        }
+    };
+};
+
+// Paces between pt2 and pt1, and chases the player while they're within 3
+// after coming within 2
+template <>
+struct AIPolicy<PATROLLER>
+{
+    static const bool FOLLOWS_FLOW = true;
+
+    static void think(Entity& enemy, const Perception& perception)
+    {
+        float position_x = enemy.m_bodies->position_x[enemy.m_body];
+
+        switch (enemy.m_ai_state) {
+        case PATROL:
+            if (perception.distance_squared < 2.0f * 2.0f) enemy.m_ai_state = WALKING;
+            if (position_x > enemy.pt1)      enemy.m_movement.x = -0.6f;
+            else if (position_x < enemy.pt2) enemy.m_movement.x = 0.6f;
+            break;
+
+        case WALKING:
+            if (perception.distance_squared < 3.0f * 3.0f) enemy.m_movement = glm::vec3(chase_direction(perception) * 1.2f, 0.0f, 0.0f);
+            else                                           enemy.m_ai_state = PATROL;
+            break;
+
+        default:
+            break;
+        }
+    };
+};
+
+// Only ever called on live enemies, which are all active, so unlike the
+// other begin_updates this doesn't go and check
+template <AIType TYPE>
+void Entity::begin_update(float delta_time, const Perception& perception)
+{
+    clear_contacts();
+    AIPolicy<TYPE>::think(*this, perception);
+    animate_and_steer(delta_time);
+}
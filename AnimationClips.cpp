@@ -0,0 +1,14 @@
+#include "AnimationClips.h"
+
+static const AnimationClip CLIPS[ANIMATION_CLIP_COUNT] =
+{
+    { 3, { 0, 1, 2 }    },  // PLAYER_WALK_DOWN
+    { 3, { 3, 4, 5 }    },  // PLAYER_WALK_LEFT
+    { 3, { 6, 7, 8 }    },  // PLAYER_WALK_RIGHT
+    { 3, { 9, 10, 11 }  },  // PLAYER_WALK_UP
+};
+
+const AnimationClip& get_animation_clip(AnimationClipId clip)
+{
+    return CLIPS[clip];
+}
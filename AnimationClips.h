@@ -0,0 +1,40 @@
+#pragma once
+
+#define MAX_CLIP_FRAMES 8
+
+// ––––– ANIMATION CLIPS ––––– //
+// Every animation in the game, defined once in AnimationClips.cpp and shared
+// by every entity that plays it. An entity only keeps which clip it's on,
+// which frame and how long it's been there.
+//
+// A clip is a list of cells of whatever sheet the entity is drawn from,
+// counted left to right and top to bottom from 0 on the grid the sheet was
+// packed with (see assets/atlas.txt). The sheet's first frame in the
+// TextureAtlas plus the cell is the frame to draw, so drawing one is a lookup.
+enum AnimationClipId
+{
+    NO_CLIP = -1,
+
+    // The "player" sheet: 3 columns by 4 rows, a row per direction
+    PLAYER_WALK_DOWN,
+    PLAYER_WALK_LEFT,
+    PLAYER_WALK_RIGHT,
+    PLAYER_WALK_UP,
+
+    ANIMATION_CLIP_COUNT
+};
+
+// Where a frame sits in a texture, in texture coordinates
+struct AtlasRect
+{
+    float u, v;
+    float width, height;
+};
+
+struct AnimationClip
+{
+    int frame_count;
+    int cells[MAX_CLIP_FRAMES];
+};
+
+const AnimationClip& get_animation_clip(AnimationClipId clip);
@@ -0,0 +1,166 @@
+#define LOG(argument) std::cout << argument << '\n'
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include "stb_image.h"
+#include "AssetLoader.h"
+
+AssetLoader::~AssetLoader()
+{
+    shutdown();
+}
+
+int AssetLoader::request(const char* path, AssetType type)
+{
+    for (int i = 0; i < (int)m_requests.size(); i++)
+    {
+        if (m_requests[i].path == path && m_requests[i].type == type) return i;
+    }
+
+    Request request = { path, type, NO_RESOURCE, false };
+    m_requests.push_back(request);
+    return (int)m_requests.size() - 1;
+}
+
+void AssetLoader::start(int worker_count)
+{
+    int request_count = (int)m_requests.size();
+
+    m_completions.reset(new Completion[request_count > 0 ? request_count : 1]);
+    for (int i = 0; i < request_count; i++) m_completions[i].ready.store(false);
+
+    if (worker_count <= 0) worker_count = (int)std::thread::hardware_concurrency();
+    if (worker_count > request_count) worker_count = request_count;
+
+    for (int i = 0; i < worker_count; i++) m_workers.push_back(std::thread(&AssetLoader::worker_main, this));
+}
+
+// The whole file into a malloc'd buffer, or leaves data NULL if it can't
+bool AssetLoader::read_file(const char* path, unsigned char*& data, size_t& bytes)
+{
+    data  = NULL;
+    bytes = 0;
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+
+    std::streamoff size = file.tellg();
+    if (size <= 0) return false;
+    file.seekg(0);
+
+    data = static_cast<unsigned char*>(malloc((size_t)size));
+    if (data == NULL) return false;
+
+    if (!file.read(reinterpret_cast<char*>(data), size))
+    {
+        free(data);
+        data = NULL;
+        return false;
+    }
+
+    bytes = (size_t)size;
+    return true;
+}
+
+void AssetLoader::worker_main()
+{
+    int request_count = (int)m_requests.size();
+
+    while (true)
+    {
+        // STEP 1: The next request nobody has claimed yet
+        int index = m_next_request.fetch_add(1);
+        if (index >= request_count) return;
+
+        const Request& request = m_requests[index];
+
+        // STEP 2: Decode it if it's an image, or just read it if it's audio.
+        // Neither touches GL or SDL, so neither cares which thread it's on.
+        Decoded decoded = {};
+        decoded.request = index;
+
+        if (request.type == ASSET_TEXTURE)
+        {
+            int number_of_components;
+            decoded.pixels = stbi_load(request.path.c_str(), &decoded.width, &decoded.height, &number_of_components, STBI_rgb_alpha);
+        }
+        else
+        {
+            read_file(request.path.c_str(), decoded.file_data, decoded.file_bytes);
+        }
+
+        // STEP 3: Into the next free slot, published only once it's all
+        // written, so the GL thread never sees half of it
+        Completion& completion = m_completions[m_next_completion.fetch_add(1)];
+        completion.decoded = decoded;
+        completion.ready.store(true, std::memory_order_release);
+    }
+}
+
+int AssetLoader::poll(ResourceCache* cache, int max_uploads)
+{
+    int landed = 0;
+
+    while (landed < max_uploads && m_next_upload < (int)m_requests.size())
+    {
+        Completion& completion = m_completions[m_next_upload];
+        if (!completion.ready.load(std::memory_order_acquire)) break;
+
+        const Decoded& decoded = completion.decoded;
+        Request& request = m_requests[decoded.request];
+        const char* path = request.path.c_str();
+
+        if (decoded.pixels != NULL)
+        {
+            request.handle = cache->create_texture(path, decoded.pixels, decoded.width, decoded.height);
+            stbi_image_free(decoded.pixels);
+        }
+        else if (decoded.file_data != NULL && request.type == ASSET_MUSIC)
+        {
+            // Music plays straight out of its source, so the file stays
+            // resident for as long as the music does, and the cache frees it
+            SDL_RWops* source = SDL_RWFromConstMem(decoded.file_data, (int)decoded.file_bytes);
+            Mix_Music* music  = Mix_LoadMUS_RW(source, 1);
+
+            if (music != NULL) request.handle = cache->adopt_music(path, music, decoded.file_data, decoded.file_bytes);
+            else               free(decoded.file_data);
+        }
+        else if (decoded.file_data != NULL && request.type == ASSET_SOUND)
+        {
+            // A chunk is decoded all at once, so the file can go straight away
+            SDL_RWops* source = SDL_RWFromConstMem(decoded.file_data, (int)decoded.file_bytes);
+            Mix_Chunk* sound  = Mix_LoadWAV_RW(source, 1);
+            free(decoded.file_data);
+
+            if (sound != NULL) request.handle = cache->adopt_sound(path, sound);
+        }
+
+        if (request.handle.generation == 0) LOG("Unable to load " << path << ". Make sure the path is correct.");
+
+        request.landed = true;
+        m_landed_count++;
+        m_next_upload++;
+        landed++;
+    }
+
+    return landed;
+}
+
+void AssetLoader::shutdown()
+{
+    for (std::thread& worker : m_workers) worker.join();
+    m_workers.clear();
+    if (!m_completions) return;  // never started
+
+    // Whatever finished decoding but never made it to the cache
+    for (; m_next_upload < (int)m_requests.size(); m_next_upload++)
+    {
+        Completion& completion = m_completions[m_next_upload];
+        if (!completion.ready.load(std::memory_order_acquire)) break;
+
+        const Decoded& decoded = completion.decoded;
+        if (decoded.pixels    != NULL) stbi_image_free(decoded.pixels);
+        if (decoded.file_data != NULL) free(decoded.file_data);
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ResourceCache.h"
+
+enum AssetType { ASSET_TEXTURE, ASSET_MUSIC, ASSET_SOUND };
+
+// Decodes images and reads audio files on worker threads while the main
+// thread gets on with the window, the shaders and the first frames.
+//
+// Everything is requested up front and then start() sets the workers off.
+// They claim requests with one atomic increment each and hand what they've
+// done back through a completion queue with a slot for every request, so
+// neither side ever takes a lock or waits on the other. poll(), on the main
+// thread, takes what's finished and puts it in the cache. Textures are
+// uploaded there, since only the thread with the context can. Audio is only
+// read into memory on the workers, because SDL_mixer promises nothing about
+// loading from other threads while it's playing; the Mix_Music or Mix_Chunk
+// is made from that memory in poll().
+//
+// Until its request has landed, an asset's handle is NO_RESOURCE, and it's
+// up to the game what to show in the meantime.
+class AssetLoader
+{
+private:
+    struct Request
+    {
+        std::string    path;
+        AssetType      type;
+        ResourceHandle handle;
+        bool           landed;
+    };
+
+    // What a worker made of a request: pixels for a texture, the whole file
+    // for audio, or neither if it couldn't be loaded
+    struct Decoded
+    {
+        int            request;
+        unsigned char* pixels;  // RGBA, from stb_image
+        int            width, height;
+        unsigned char* file_data;  // malloc'd
+        size_t         file_bytes;
+    };
+
+    // One slot per request, filled in whatever order the workers finish and
+    // read back in that order. A worker claims the next slot, writes it and
+    // then publishes it; the queue never wraps, so that's all it takes.
+    struct Completion
+    {
+        Decoded           decoded;
+        std::atomic<bool> ready;
+    };
+
+    std::vector<Request>          m_requests;  // fixed once start() is called
+    std::unique_ptr<Completion[]> m_completions;
+    std::atomic<int>              m_next_request{ 0 };
+    std::atomic<int>              m_next_completion{ 0 };
+    int                           m_next_upload = 0;  // only the GL thread touches this
+    int                           m_landed_count = 0;
+
+    std::vector<std::thread> m_workers;
+
+    static bool read_file(const char* path, unsigned char*& data, size_t& bytes);
+    void worker_main();
+
+public:
+    // ————— METHODS ————— //
+    AssetLoader() = default;
+    ~AssetLoader();
+
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    // Before start() only. Returns the request's id, the same one for a path
+    // that's already been asked for.
+    int request(const char* path, AssetType type);
+
+    // worker_count is capped at the number of requests; 0 means one per
+    // hardware thread. Sounds are converted to the audio device's format as
+    // they land, so open it before the first poll().
+    void start(int worker_count);
+
+    // Lands at most max_uploads finished assets in the cache and returns how
+    // many it landed. Main thread only. Uploading textures and decoding
+    // sounds are the slow part, so the limit keeps any one frame from taking
+    // the hit for all of them.
+    int poll(ResourceCache* cache, int max_uploads);
+
+    // Waits for the workers and frees anything decoded that never landed
+    void shutdown();
+
+    // ————— GETTERS ————— //
+    // NO_RESOURCE until it's landed, and for good if it couldn't be loaded
+    ResourceHandle const get_handle(int request) const { return m_requests[request].handle; };
+    bool           const has_landed(int request) const { return m_requests[request].landed; };
+
+    int  const get_request_count() const { return (int)m_requests.size();                    };
+    int  const get_landed_count()  const { return m_landed_count;                            };
+    bool const is_done()           const { return m_landed_count == (int)m_requests.size(); };
+};
@@ -0,0 +1,108 @@
+#include <cmath>
+#include "BodyStore.h"
+
+void BodyStore::reserve(int count)
+{
+    position_x.reserve(count);     position_y.reserve(count);
+    velocity_x.reserve(count);     velocity_y.reserve(count);
+    acceleration_x.reserve(count); acceleration_y.reserve(count);
+    previous_x.reserve(count);     previous_y.reserve(count);
+    half_width.reserve(count);     half_height.reserve(count);
+    active.reserve(count);
+    asleep.reserve(count);
+}
+
+void BodyStore::clear()
+{
+    position_x.clear();     position_y.clear();
+    velocity_x.clear();     velocity_y.clear();
+    acceleration_x.clear(); acceleration_y.clear();
+    previous_x.clear();     previous_y.clear();
+    half_width.clear();     half_height.clear();
+    active.clear();
+    asleep.clear();
+
+    m_count = 0;
+}
+
+int BodyStore::create()
+{
+    position_x.push_back(0.0f);     position_y.push_back(0.0f);
+    velocity_x.push_back(0.0f);     velocity_y.push_back(0.0f);
+    acceleration_x.push_back(0.0f); acceleration_y.push_back(0.0f);
+    previous_x.push_back(0.0f);     previous_y.push_back(0.0f);
+    half_width.push_back(0.5f);     half_height.push_back(0.5f);
+    active.push_back(1.0f);
+    asleep.push_back(0);
+
+    return m_count++;
+}
+
+void BodyStore::place(int body, float x, float y)
+{
+    position_x[body] = x; position_y[body] = y;
+    previous_x[body] = x; previous_y[body] = y;
+}
+
+// The loops below are kept to plain, restrict-qualified array arithmetic on
+// purpose: that is the shape both MSVC and GCC vectorise without help.
+
+void BodyStore::integrate_velocity(int first, int count, float delta_time)
+{
+    float* __restrict vx = velocity_x.data() + first;
+    float* __restrict vy = velocity_y.data() + first;
+    const float* __restrict ax = acceleration_x.data() + first;
+    const float* __restrict ay = acceleration_y.data() + first;
+    const float* __restrict on = active.data() + first;
+
+    for (int i = 0; i < count; i++)
+    {
+        float step = delta_time * on[i];
+        vx[i] += ax[i] * step;
+        vy[i] += ay[i] * step;
+    }
+}
+
+void BodyStore::integrate_position_x(int first, int count, float delta_time)
+{
+    float* __restrict px = position_x.data() + first;
+    float* __restrict previous = previous_x.data() + first;
+    const float* __restrict vx = velocity_x.data() + first;
+    const float* __restrict on = active.data() + first;
+
+    for (int i = 0; i < count; i++)
+    {
+        previous[i] = px[i];
+        px[i] += vx[i] * (delta_time * on[i]);
+    }
+}
+
+void BodyStore::integrate_position_y(int first, int count, float delta_time)
+{
+    float* __restrict py = position_y.data() + first;
+    float* __restrict previous = previous_y.data() + first;
+    const float* __restrict vy = velocity_y.data() + first;
+    const float* __restrict on = active.data() + first;
+
+    for (int i = 0; i < count; i++)
+    {
+        previous[i] = py[i];
+        py[i] += vy[i] * (delta_time * on[i]);
+    }
+}
+
+void BodyStore::swept_x(int body, float& center_x, float& half_width_swept) const
+{
+    float low  = std::fmin(previous_x[body], position_x[body]) - half_width[body];
+    float high = std::fmax(previous_x[body], position_x[body]) + half_width[body];
+    center_x = (low + high) * 0.5f;
+    half_width_swept = (high - low) * 0.5f;
+}
+
+void BodyStore::swept_y(int body, float& center_y, float& half_height_swept) const
+{
+    float low  = std::fmin(previous_y[body], position_y[body]) - half_height[body];
+    float high = std::fmax(previous_y[body], position_y[body]) + half_height[body];
+    center_y = (low + high) * 0.5f;
+    half_height_swept = (high - low) * 0.5f;
+}
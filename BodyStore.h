@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+
+// Physics state for every body in the world, stored as one array per field
+// rather than one struct per body. The integrate passes then stream through
+// exactly the floats they touch, which the compiler turns into SIMD loops.
+//
+// Dynamic bodies (player, enemies) are created first and static ones
+// (platforms) after, so a pass over [0, dynamic count) never visits a platform.
+class BodyStore
+{
+private:
+    int m_count = 0;
+
+public:
+    // ––––– PHYSICS ––––– //
+    std::vector<float> position_x,     position_y;
+    std::vector<float> velocity_x,     velocity_y;
+    std::vector<float> acceleration_x, acceleration_y;
+
+    // Where each body was before the last integrate_position pass on that
+    // axis, so collision can test the whole path it took and not just where
+    // it ended up
+    std::vector<float> previous_x,     previous_y;
+
+    // ––––– EXTENTS ––––– //
+    std::vector<float> half_width, half_height;
+
+    // ––––– FLAGS ––––– //
+    // 1.0f or 0.0f, so the integrate loops can multiply instead of branch
+    std::vector<float> active;
+
+    // 1 while a resting body is asleep: it keeps its place and still gets hit,
+    // but the world leaves it out of its integrate and collision passes
+    std::vector<unsigned char> asleep;
+
+    // ————— METHODS ————— //
+    void reserve(int count);
+    void clear();
+    int  create();
+
+    // Puts a body somewhere outright, as at spawn or level load. It didn't
+    // travel there, so previous_* goes with it and there's no path to sweep
+    // or to interpolate along.
+    void place(int body, float x, float y);
+
+    void integrate_velocity(int first, int count, float delta_time);
+    void integrate_position_x(int first, int count, float delta_time);
+    void integrate_position_y(int first, int count, float delta_time);
+
+    // The span a body covered along one axis in its last integrate_position
+    // pass, from previous_* to where it is now, as a center and half extent
+    void swept_x(int body, float& center_x, float& half_width_swept) const;
+    void swept_y(int body, float& center_y, float& half_height_swept) const;
+
+    // ————— GETTERS ————— //
+    int const get_count() const { return m_count; };
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <chrono>
+
+// ––––– CLOCKS ––––– //
+// The world only ever asks "what time is it?", so the game can hand it a real
+// clock and the headless driver can hand it one that it advances by itself.
+// Seconds are doubles: a float is down to whole-millisecond steps after a
+// couple of hours of uptime.
+class Clock
+{
+public:
+    virtual ~Clock() {};
+    virtual double get_seconds() = 0;
+};
+
+// Monotonic and far finer than a millisecond, unlike SDL_GetTicks; counts
+// from when the clock was made
+class SteadyClock : public Clock
+{
+private:
+    std::chrono::steady_clock::time_point m_start = std::chrono::steady_clock::now();
+
+public:
+    double get_seconds() override { return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count(); };
+};
+
+class ManualClock : public Clock
+{
+private:
+    double m_seconds = 0.0;
+
+public:
+    void   advance(double seconds) { m_seconds += seconds; };
+    double get_seconds() override  { return m_seconds;     };
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "EntityTable.h"
+
+// One thing a collision pass stopped an entity against: A is the entity that
+// was moved, B what it ran into (NO_ENTITY for static geometry), the normal
+// points from B out towards A along the axis it was stopped on, and the
+// penetration is how far A was pushed back out.
+struct Contact
+{
+    EntityHandle a, b;
+    float normal_x, normal_y;
+    float penetration;
+};
+
+// Every contact of one step, in the order the collision passes found them.
+// The passes only append; gameplay reads the lot back in one go once
+// they're done, and the world clears it at the start of the next step.
+//
+// The buffer keeps the biggest size it's grown to, so after the first busy
+// step or two appending never touches the heap.
+class ContactBuffer
+{
+private:
+    std::vector<Contact> m_contacts;
+
+public:
+    // ————— METHODS ————— //
+    void reserve(size_t capacity) { m_contacts.reserve(capacity); };
+    void clear()                  { m_contacts.clear();           };
+
+    void push(EntityHandle a, EntityHandle b, float normal_x, float normal_y, float penetration)
+    {
+        Contact contact = { a, b, normal_x, normal_y, penetration };
+        m_contacts.push_back(contact);
+    };
+
+    // ————— GETTERS ————— //
+    const Contact* get_contacts()      const { return m_contacts.data();       };
+    int      const get_contact_count() const { return (int)m_contacts.size();  };
+};
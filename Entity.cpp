@@ -10,7 +10,11 @@
 
 #define GL_SILENCE_DEPRECATION
 #define STB_IMAGE_IMPLEMENTATION
+#define CONTACT_TOLERANCE 0.001f  // a body resting on a face can sit this far inside it from rounding
+#define SLEEP_TICKS 30            // resting ticks in a row before a body falls asleep
+#define SLEEP_VELOCITY 0.0001f    // slower than this on both axes counts as resting
 
+#ifndef HEADLESS
 #ifdef _WINDOWS
 #include <GL/glew.h>
 #endif
@@ -18,221 +22,92 @@
 #define GL_GLEXT_PROTOTYPES 1
 #include <SDL.h>
 #include <SDL_opengl.h>
+#include "SpriteInstances.h"
+#endif
+
+#include <cstring>
+#include <utility>
 #include "glm/mat4x4.hpp"
 #include "glm/gtc/matrix_transform.hpp"
-#include "ShaderProgram.h"
-#include "Entity.h"
+#include "AIPolicies.h"
+#include "StaticMap.h"
 
 Entity::Entity()
 {
-    // ––––– PHYSICS ––––– //
-    m_position = glm::vec3(0.0f);
-    m_velocity = glm::vec3(0.0f);
-    m_acceleration = glm::vec3(0.0f);
-
     // ––––– TRANSLATION ––––– //
     m_movement = glm::vec3(0.0f);
     m_speed = 0;
-    m_model_matrix = glm::mat4(1.0f);
 }
 
-Entity::~Entity()
+// A table of every policy's think(), built from the AIType list, so this
+// stays right as types are added
+template <size_t... TYPES>
+static void think_as(AIType type, Entity& enemy, const Perception& perception, std::index_sequence<TYPES...>)
 {
-    delete[] m_animation_up;
-    delete[] m_animation_down;
-    delete[] m_animation_left;
-    delete[] m_animation_right;
-    delete[] m_walking;
+    static void (*const think[])(Entity&, const Perception&) = { &AIPolicy<(AIType)TYPES>::think... };
+    think[type](enemy, perception);
 }
 
-void Entity::draw_sprite_from_texture_atlas(ShaderProgram* program, GLuint texture_id, int index)
+void Entity::ai_activate(const Perception& perception)
 {
-    // Step 1: Calculate the UV location of the indexed frame
-    float u_coord = (float)(index % m_animation_cols) / (float)m_animation_cols;
-    float v_coord = (float)(index / m_animation_cols) / (float)m_animation_rows;
-
-    // Step 2: Calculate its UV size
-    float width = 1.0f / (float)m_animation_cols;
-    float height = 1.0f / (float)m_animation_rows;
-
-    // Step 3: Just as we have done before, match the texture coordinates to the vertices
-    float tex_coords[] =
-    {
-        u_coord, v_coord + height, u_coord + width, v_coord + height, u_coord + width, v_coord,
-        u_coord, v_coord + height, u_coord + width, v_coord, u_coord, v_coord
-    };
-
-    float vertices[] =
-    {
-        -0.5, -0.5, 0.5, -0.5,  0.5, 0.5,
-        -0.5, -0.5, 0.5,  0.5, -0.5, 0.5
-    };
-
-    // Step 4: And render
-    glBindTexture(GL_TEXTURE_2D, texture_id);
-
-    glVertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices);
-    glEnableVertexAttribArray(program->get_position_attribute());
-
-    glVertexAttribPointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, tex_coords);
-    glEnableVertexAttribArray(program->get_tex_coordinate_attribute());
-
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-
-    glDisableVertexAttribArray(program->get_position_attribute());
-    glDisableVertexAttribArray(program->get_tex_coordinate_attribute());
+    think_as(m_ai_type, *this, perception, std::make_index_sequence<AI_TYPE_COUNT>());
 }
 
-void Entity::ai_activate(Entity* player)
+void Entity::update(float delta_time, Entity* player, Entity** collidable_entities, int collidable_entity_count)
 {
-    switch (m_ai_type)
-    {
-    case WALKER:
-        ai_walk();
-        break;
-
-    case GUARD:
-        ai_guard(player);
-        break;
+    if (!is_active()) return;
 
-    case RUNNER:
-        ai_run(player);
-        break;
+    begin_update(delta_time, player != NULL ? perceive(player) : Perception());
 
-    case JUMPER:
-        ai_jump();
-        break;
+    m_bodies->integrate_velocity(m_body, 1, delta_time);
 
-    case PATROLLER:
-        ai_patrol(player, pt1, pt2);
-        break;
+    m_bodies->integrate_position_y(m_body, 1, delta_time);
+    check_collision_y(collidable_entities, collidable_entity_count);
 
+    m_bodies->integrate_position_x(m_body, 1, delta_time);
+    check_collision_x(collidable_entities, collidable_entity_count);
 
-    default:
-        break;
-    }
+    end_update();
 }
 
-void Entity::ai_walk()
+Perception Entity::perceive(const Entity* player) const
 {
-    m_movement = glm::vec3(-1.0f, 0.0f, 0.0f);
-}
+    float position_x = m_bodies->position_x[m_body];
+    float position_y = m_bodies->position_y[m_body];
+    Perception perception = {};
 
-//NEW
-void Entity::ai_jump()
-{
-    if (!m_is_jumping) {
-        m_velocity.y = m_jumping_power;
-        m_is_jumping = true;
-    }
+    perceive_point(player->m_bodies->position_x[player->m_body], player->m_bodies->position_y[player->m_body],
+                   &position_x, &position_y, 1, &perception.distance_squared, &perception.offset_x);
+
+    return perception;
 }
 
-void Entity::ai_guard(Entity* player)
+void Entity::begin_update(float delta_time, const Perception& perception)
 {
-    switch (m_ai_state) {
-    case IDLE:
-        if (glm::distance(m_position, player->get_position()) < 3.0f) m_ai_state = WALKING;
-        break;
-
-    case WALKING:
-        if (m_position.x > player->get_position().x) {
-            m_movement = glm::vec3(-1.0f, 0.0f, 0.0f);
-        }
-        else {
-            m_movement = glm::vec3(1.0f, 0.0f, 0.0f);
-        }
-        break;
-
-    case ATTACKING:
-        break;
+    if (!is_active()) return;
 
-    default:
-        break;
-    }
+    clear_contacts();
+    if (m_entity_type == ENEMY) ai_activate(perception);
+    animate_and_steer(delta_time);
 }
 
-void Entity::ai_patrol(Entity* player, float pt1, float pt2)
+void Entity::begin_update(float delta_time)
 {
-    switch (m_ai_state) {
-    case PATROL:
-        if (glm::distance(m_position, player->get_position()) < 2.0f) m_ai_state = WALKING;
-        if (m_position.x > pt1) {
-            m_movement.x = -0.6f;
-        }
-        else if (m_position.x < pt2) {
-            m_movement.x = 0.6f;
-        }
-        break;
+    if (!is_active()) return;
 
-    case WALKING:
-        if (glm::distance(m_position, player->get_position()) < 3.0f) {
-            if (m_position.x > player->get_position().x) {
-                m_movement = glm::vec3(-1.2f, 0.0f, 0.0f);
-            }
-            else {
-                m_movement = glm::vec3(1.2f, 0.0f, 0.0f);
-            }
-        }
-        else {
-            m_ai_state = PATROL;
-        }
-        break;
-
-    case ATTACKING:
-        break;
-
-    default:
-        break;
-    }
+    clear_contacts();
+    animate_and_steer(delta_time);
 }
 
-void Entity::ai_run(Entity* player)
+void Entity::clear_contacts()
 {
-    switch (m_ai_state) {
-    case IDLE:
-        if (glm::distance(m_position, player->get_position()) < 2.0f) m_ai_state = RUNNING;
-        break;
-
-    case RUNNING:
-        if (glm::distance(m_position, player->get_position()) < 1.5f) {
-            if (m_position.x > player->get_position().x) {
-                m_movement = glm::vec3(2.0f, 0.0f, 0.0f);
-            }
-            else {
-                m_movement = glm::vec3(-2.0f, 0.0f, 0.0f);
-            }
-        }
-        else {
-            set_ai_state(IDLE);
-        }
-        break;
-
-    case ATTACKING:
-        break;
-
-    default:
-        break;
-    }
+    m_contacts = 0;
 }
 
-void Entity::update(float delta_time, Entity* player, Entity* collidable_entities, int collidable_entity_count)
+void Entity::animate_and_steer(float delta_time)
 {
-    if (!m_is_active) return;
-
-    m_collided_top = false;
-    m_collided_bottom = false;
-    m_collided_left = false;
-    m_collided_right = false;
-
-    top_enemy = false;
-    bottom_enemy = false;
-    left_enemy = false;
-    right_enemy = false;
-
-    if (m_entity_type == ENEMY) ai_activate(player);
-
     // ––––– ANIMATION ––––– //
-    if (m_animation_indices != NULL)
+    if (m_animation_clip != NO_CLIP)
     {
         if (glm::length(m_movement) != 0)
         {
@@ -244,7 +119,7 @@ void Entity::update(float delta_time, Entity* player, Entity* collidable_entitie
                 m_animation_time = 0.0f;
                 m_animation_index++;
 
-                if (m_animation_index >= m_animation_frames)
+                if (m_animation_index >= get_animation_clip(m_animation_clip).frame_count)
                 {
                     m_animation_index = 0;
                 }
@@ -253,14 +128,16 @@ void Entity::update(float delta_time, Entity* player, Entity* collidable_entitie
     }
 
     // ––––– GRAVITY ––––– //
-    m_velocity.x = m_movement.x * m_speed;
-    m_velocity += m_acceleration * delta_time;
+    // Only the horizontal velocity is set here; adding the acceleration and
+    // moving the body is left to the BodyStore integrate passes
+    m_bodies->velocity_x[m_body] = m_movement.x * m_speed;
+}
 
-    m_position.y += m_velocity.y * delta_time;
-    check_collision_y(collidable_entities, collidable_entity_count);
+void Entity::end_update()
+{
+    if (!is_active()) return;
 
-    m_position.x += m_velocity.x * delta_time;
-    check_collision_x(collidable_entities, collidable_entity_count);
+    float& velocity_y = m_bodies->velocity_y[m_body];
 
     /*
     // ––––– JUMPING ––––– //
@@ -275,7 +152,7 @@ void Entity::update(float delta_time, Entity* player, Entity* collidable_entitie
     */
     //NEW JUMPING
     if (m_entity_type == ENEMY && m_ai_type == JUMPER) {
-        if (m_collided_bottom) {
+        if (m_contacts & CONTACT_BOTTOM) {
             m_is_jumping = false;
         }
     }
@@ -286,114 +163,380 @@ void Entity::update(float delta_time, Entity* player, Entity* collidable_entitie
             m_is_jumping = false;
 
             // STEP 2: The player now acquires an upward velocity
-            m_velocity.y += m_jumping_power;
+            velocity_y += m_jumping_power;
         }
     }
+}
+
+// A body is resting when it's standing on something with nothing asking it to
+// move. Every tick it then comes out exactly where it went in (gravity pulls
+// it into the floor and the floor puts it back), so after SLEEP_TICKS of that
+// it can skip the passes altogether until something wakes it.
+void Entity::update_sleep()
+{
+    if (!is_active()) return;
+
+    bool resting = (m_contacts & CONTACT_BOTTOM) && !m_is_jumping && m_movement == glm::vec3(0.0f) &&
+                   fabs(m_bodies->velocity_x[m_body]) < SLEEP_VELOCITY &&
+                   fabs(m_bodies->velocity_y[m_body]) < SLEEP_VELOCITY;
+
+    m_still_ticks = resting ? m_still_ticks + 1 : 0;
+    if (m_still_ticks >= SLEEP_TICKS) m_bodies->asleep[m_body] = 1;
+}
+
+void Entity::wake()
+{
+    m_bodies->asleep[m_body] = 0;
+    m_still_ticks = 0;
+}
+
+// How far into its last move, from 0 to 1, a body first touched the other box
+// along one axis, or -1 if it was already inside it or never got that far.
+// Only meaningful when the two already overlap on the other axis.
+static float entry_time(float previous, float position, float half, float other, float other_half)
+{
+    float displacement = position - previous;
+    if (displacement == 0.0f) return -1.0f;
+
+    float gap = displacement > 0.0f ? (other - other_half) - (previous + half)
+                                    : (previous - half) - (other + other_half);
+    if (gap < -CONTACT_TOLERANCE) return -1.0f;
+
+    float time = (gap > 0.0f ? gap : 0.0f) / fabs(displacement);
+    return time <= 1.0f ? time : -1.0f;
+}
+
+void Entity::stop_y(float stop_position_y, bool moving_up, EntityHandle other)
+{
+    float penetration = fabs(m_bodies->position_y[m_body] - stop_position_y);
+    m_bodies->position_y[m_body] = stop_position_y;
+    m_bodies->velocity_y[m_body] = 0;
 
-    // ––––– TRANSFORMATIONS ––––– //
-    m_model_matrix = glm::mat4(1.0f);
-    m_model_matrix = glm::translate(m_model_matrix, m_position);
+    m_contacts |= moving_up ? CONTACT_TOP : CONTACT_BOTTOM;
+    if (m_contact_buffer != nullptr) m_contact_buffer->push(m_handle, other, 0.0f, moving_up ? -1.0f : 1.0f, penetration);
 }
 
-void const Entity::check_collision_y(Entity* collidable_entities, int collidable_entity_count)
+void Entity::stop_x(float stop_position_x, bool moving_right, EntityHandle other)
 {
+    float penetration = fabs(m_bodies->position_x[m_body] - stop_position_x);
+    m_bodies->position_x[m_body] = stop_position_x;
+    m_bodies->velocity_x[m_body] = 0;
+
+    m_contacts |= moving_right ? CONTACT_RIGHT : CONTACT_LEFT;
+    if (m_contact_buffer != nullptr) m_contact_buffer->push(m_handle, other, moving_right ? -1.0f : 1.0f, 0.0f, penetration);
+}
+
+void Entity::resolve_y(float other_y, float other_half_height, EntityHandle other)
+{
+    float position_y = m_bodies->position_y[m_body];
+    float velocity_y = m_bodies->velocity_y[m_body];
+
+    float y_distance = fabs(position_y - other_y);
+    float y_overlap = fabs(y_distance - m_bodies->half_height[m_body] - other_half_height);
+    if (velocity_y > 0) {
+        stop_y(position_y - y_overlap, true, other);
+    }
+    else if (velocity_y < 0) {
+        stop_y(position_y + y_overlap, false, other);
+    }
+}
+
+void Entity::resolve_x(float other_x, float other_half_width, EntityHandle other)
+{
+    float position_x = m_bodies->position_x[m_body];
+    float velocity_x = m_bodies->velocity_x[m_body];
+
+    float x_distance = fabs(position_x - other_x);
+    float x_overlap = fabs(x_distance - m_bodies->half_width[m_body] - other_half_width);
+    if (velocity_x > 0) {
+        stop_x(position_x - x_overlap, true, other);
+    }
+    else if (velocity_x < 0) {
+        stop_x(position_x + x_overlap, false, other);
+    }
+}
+
+// Collision runs in two steps per axis. First the swept test: of everything
+// the body's path since the integrate pass crossed into, the earliest one
+// stops it at its face, however far the step would have carried it. That is
+// what keeps fast movers and long steps from tunnelling. Then the old overlap
+// test pushes the body out of anything it was already inside at the start.
+// When nothing is fast enough to cross a box in one step, both give the same
+// answer the overlap test alone used to.
+void const Entity::check_collision_y(Entity** collidable_entities, int collidable_entity_count)
+{
+    if (!is_active()) return;
+
+    const BodyStore& bodies = *m_bodies;
+    float previous_y = bodies.previous_y[m_body], position_y = bodies.position_y[m_body];
+    float half_width = bodies.half_width[m_body], half_height = bodies.half_height[m_body];
+
+    // STEP 1: Earliest entity moved into
+    Entity* first_hit  = nullptr;
+    float   first_time = 2.0f;
+
+    for (int i = 0; i < collidable_entity_count; i++)
+    {
+        Entity* collidable_entity = collidable_entities[i];
+        if (collidable_entity == this || !collidable_entity->is_active()) continue;
+
+        int other = collidable_entity->m_body;
+        if (fabs(bodies.position_x[m_body] - bodies.position_x[other]) - (half_width + bodies.half_width[other]) >= 0.0f) continue;
+
+        float time = entry_time(previous_y, position_y, half_height, bodies.position_y[other], bodies.half_height[other]);
+        if (time >= 0.0f && time < first_time)
+        {
+            first_hit  = collidable_entity;
+            first_time = time;
+        }
+    }
+
+    if (first_hit != nullptr)
+    {
+        int other = first_hit->m_body;
+        bool moving_up = position_y > previous_y;
+        float face = moving_up ? bodies.position_y[other] - bodies.half_height[other] - half_height
+                               : bodies.position_y[other] + bodies.half_height[other] + half_height;
+        stop_y(face, moving_up, first_hit->m_handle);
+    }
+
+    // STEP 2: Anything still overlapped
     for (int i = 0; i < collidable_entity_count; i++)
     {
-        Entity* collidable_entity = &collidable_entities[i];
+        Entity* collidable_entity = collidable_entities[i];
 
         if (check_collision(collidable_entity))
         {
-            float y_distance = fabs(m_position.y - collidable_entity->get_position().y);
-            float y_overlap = fabs(y_distance - (m_height / 2.0f) - (collidable_entity->get_height() / 2.0f));
-            if (m_velocity.y > 0) {
-                m_position.y -= y_overlap;
-                m_velocity.y = 0;
-                m_collided_top = true;
-                if (collidable_entity->m_entity_type == ENEMY) {
-                    top_enemy = true;
-                }
-            }
-            else if (m_velocity.y < 0) {
-                m_position.y += y_overlap;
-                m_velocity.y = 0;
-                m_collided_bottom = true;
-                if (collidable_entity->m_entity_type == ENEMY) {
-                    bottom_enemy = true;
-                }
-            }
+            int other = collidable_entity->m_body;
+            resolve_y(m_bodies->position_y[other], m_bodies->half_height[other], collidable_entity->m_handle);
         }
     }
 }
 
-void const Entity::check_collision_x(Entity* collidable_entities, int collidable_entity_count)
+void const Entity::check_collision_x(Entity** collidable_entities, int collidable_entity_count)
 {
+    if (!is_active()) return;
+
+    const BodyStore& bodies = *m_bodies;
+    float previous_x = bodies.previous_x[m_body], position_x = bodies.position_x[m_body];
+    float half_width = bodies.half_width[m_body], half_height = bodies.half_height[m_body];
+
+    // STEP 1: Earliest entity moved into
+    Entity* first_hit  = nullptr;
+    float   first_time = 2.0f;
+
     for (int i = 0; i < collidable_entity_count; i++)
     {
-        Entity* collidable_entity = &collidable_entities[i];
+        Entity* collidable_entity = collidable_entities[i];
+        if (collidable_entity == this || !collidable_entity->is_active()) continue;
+
+        int other = collidable_entity->m_body;
+        if (fabs(bodies.position_y[m_body] - bodies.position_y[other]) - (half_height + bodies.half_height[other]) >= 0.0f) continue;
+
+        float time = entry_time(previous_x, position_x, half_width, bodies.position_x[other], bodies.half_width[other]);
+        if (time >= 0.0f && time < first_time)
+        {
+            first_hit  = collidable_entity;
+            first_time = time;
+        }
+    }
+
+    if (first_hit != nullptr)
+    {
+        int other = first_hit->m_body;
+        bool moving_right = position_x > previous_x;
+        float face = moving_right ? bodies.position_x[other] - bodies.half_width[other] - half_width
+                                  : bodies.position_x[other] + bodies.half_width[other] + half_width;
+        stop_x(face, moving_right, first_hit->m_handle);
+    }
+
+    // STEP 2: Anything still overlapped
+    for (int i = 0; i < collidable_entity_count; i++)
+    {
+        Entity* collidable_entity = collidable_entities[i];
 
         if (check_collision(collidable_entity))
         {
-            float x_distance = fabs(m_position.x - collidable_entity->get_position().x);
-            float x_overlap = fabs(x_distance - (m_width / 2.0f) - (collidable_entity->get_width() / 2.0f));
-            if (m_velocity.x > 0) {
-                m_position.x -= x_overlap;
-                m_velocity.x = 0;
-                m_collided_right = true;
-                if (collidable_entity->m_entity_type == ENEMY) {
-                    right_enemy = true;
-                }
-            }
-            else if (m_velocity.x < 0) {
-                m_position.x += x_overlap;
-                m_velocity.x = 0;
-                m_collided_left = true;
-                if (collidable_entity->m_entity_type == ENEMY) {
-                    left_enemy = true;
-                }
-            }
+            int other = collidable_entity->m_body;
+            resolve_x(m_bodies->position_x[other], m_bodies->half_width[other], collidable_entity->m_handle);
         }
     }
 }
 
+// Static geometry gets the same two steps, but the boxes come straight out of
+// the baked map's cells. The earliest hit is looked for in everything the
+// swept box touches, however many platforms that is, so a fast body can't
+// skip the one it reaches first; ties go to the lowest id. What's still
+// overlapped afterwards is found around where the body ended up.
+void const Entity::check_static_collision_y(const StaticMap& map)
+{
+    if (!is_active()) return;
+
+    // This is the first collision pass of a step, so the contacts start over
+    // here too; an enemy the AI scheduler skipped never ran begin_update
+    clear_contacts();
+
+    const BodyStore& bodies = *m_bodies;
+    float previous_y = bodies.previous_y[m_body];
+    float swept_y, swept_half_height;
+    bodies.swept_y(m_body, swept_y, swept_half_height);
+
+    // STEP 1: Earliest box moved into
+    int   first_hit  = -1;
+    float first_time = 2.0f;
+
+    map.for_each_overlapping(bodies.position_x[m_body], swept_y, bodies.half_width[m_body], swept_half_height,
+        [&](int id, const StaticBox& box) {
+            float time = entry_time(previous_y, bodies.position_y[m_body], bodies.half_height[m_body], box.center_y, box.half_height);
+            if (time >= 0.0f && (time < first_time || (time == first_time && id < first_hit)))
+            {
+                first_hit  = id;
+                first_time = time;
+            }
+        });
+
+    if (first_hit >= 0)
+    {
+        const StaticBox& box = map.get_box(first_hit);
+        bool moving_up = bodies.position_y[m_body] > previous_y;
+        stop_y(moving_up ? box.center_y - box.half_height - bodies.half_height[m_body]
+                         : box.center_y + box.half_height + bodies.half_height[m_body], moving_up, NO_ENTITY);
+    }
+
+    // STEP 2: Anything still overlapped, lowest id first
+    int boxes[StaticMap::MAX_OVERLAPS];
+    int box_count = map.find_overlapping(bodies.position_x[m_body], bodies.position_y[m_body],
+                                         bodies.half_width[m_body], bodies.half_height[m_body], boxes, StaticMap::MAX_OVERLAPS);
+
+    for (int i = 0; i < box_count; i++)
+    {
+        const StaticBox& box = map.get_box(boxes[i]);
+
+        // An earlier box may already have pushed us clear of this one
+        float x_distance = fabs(bodies.position_x[m_body] - box.center_x) - (bodies.half_width[m_body] + box.half_width);
+        float y_distance = fabs(bodies.position_y[m_body] - box.center_y) - (bodies.half_height[m_body] + box.half_height);
+        if (x_distance < 0.0f && y_distance < 0.0f) resolve_y(box.center_y, box.half_height, NO_ENTITY);
+    }
+}
 
-void Entity::render(ShaderProgram* program)
+void const Entity::check_static_collision_x(const StaticMap& map)
 {
-    program->set_model_matrix(m_model_matrix);
+    if (!is_active()) return;
 
-    if (m_animation_indices != NULL)
+    const BodyStore& bodies = *m_bodies;
+    float previous_x = bodies.previous_x[m_body];
+    float swept_x, swept_half_width;
+    bodies.swept_x(m_body, swept_x, swept_half_width);
+
+    // STEP 1: Earliest box moved into
+    int   first_hit  = -1;
+    float first_time = 2.0f;
+
+    map.for_each_overlapping(swept_x, bodies.position_y[m_body], swept_half_width, bodies.half_height[m_body],
+        [&](int id, const StaticBox& box) {
+            float time = entry_time(previous_x, bodies.position_x[m_body], bodies.half_width[m_body], box.center_x, box.half_width);
+            if (time >= 0.0f && (time < first_time || (time == first_time && id < first_hit)))
+            {
+                first_hit  = id;
+                first_time = time;
+            }
+        });
+
+    if (first_hit >= 0)
     {
-        draw_sprite_from_texture_atlas(program, m_texture_id, m_animation_indices[m_animation_index]);
-        return;
+        const StaticBox& box = map.get_box(first_hit);
+        bool moving_right = bodies.position_x[m_body] > previous_x;
+        stop_x(moving_right ? box.center_x - box.half_width - bodies.half_width[m_body]
+                            : box.center_x + box.half_width + bodies.half_width[m_body], moving_right, NO_ENTITY);
     }
 
-    float vertices[] = { -0.5, -0.5, 0.5, -0.5, 0.5, 0.5, -0.5, -0.5, 0.5, 0.5, -0.5, 0.5 };
-    float tex_coords[] = { 0.0,  1.0, 1.0,  1.0, 1.0, 0.0,  0.0,  1.0, 1.0, 0.0,  0.0, 0.0 };
+    // STEP 2: Anything still overlapped, lowest id first
+    int boxes[StaticMap::MAX_OVERLAPS];
+    int box_count = map.find_overlapping(bodies.position_x[m_body], bodies.position_y[m_body],
+                                         bodies.half_width[m_body], bodies.half_height[m_body], boxes, StaticMap::MAX_OVERLAPS);
 
-    glBindTexture(GL_TEXTURE_2D, m_texture_id);
+    for (int i = 0; i < box_count; i++)
+    {
+        const StaticBox& box = map.get_box(boxes[i]);
 
-    glVertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices);
-    glEnableVertexAttribArray(program->get_position_attribute());
-    glVertexAttribPointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, tex_coords);
-    glEnableVertexAttribArray(program->get_tex_coordinate_attribute());
+        float x_distance = fabs(bodies.position_x[m_body] - box.center_x) - (bodies.half_width[m_body] + box.half_width);
+        float y_distance = fabs(bodies.position_y[m_body] - box.center_y) - (bodies.half_height[m_body] + box.half_height);
+        if (x_distance < 0.0f && y_distance < 0.0f) resolve_x(box.center_x, box.half_width, NO_ENTITY);
+    }
+}
 
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+void Entity::save_state(EntityState& state) const
+{
+    // Zeroed first so the same state always gives the same bytes
+    memset(&state, 0, sizeof(state));
+
+    state.movement_x      = m_movement.x;
+    state.movement_y      = m_movement.y;
+    state.movement_z      = m_movement.z;
+    state.animation_time  = m_animation_time;
+    state.animation_index = m_animation_index;
+    state.still_ticks     = m_still_ticks;
+    state.ai_state        = (int)m_ai_state;
+    state.ai_type         = (int)m_ai_type;
+    state.speed           = m_speed;
+    state.jumping_power   = m_jumping_power;
+    state.pt1             = pt1;
+    state.pt2             = pt2;
+
+    state.animation_clip  = (int)m_animation_clip;
+
+    state.is_jumping      = m_is_jumping;
+    state.contacts        = m_contacts;
+}
 
-    glDisableVertexAttribArray(program->get_position_attribute());
-    glDisableVertexAttribArray(program->get_tex_coordinate_attribute());
+void Entity::load_state(const EntityState& state)
+{
+    m_movement        = glm::vec3(state.movement_x, state.movement_y, state.movement_z);
+    m_animation_time  = state.animation_time;
+    m_animation_index = state.animation_index;
+    m_still_ticks     = state.still_ticks;
+    m_ai_state        = (AIState)state.ai_state;
+    m_ai_type         = (AIType)state.ai_type;
+    m_speed           = state.speed;
+    m_jumping_power   = state.jumping_power;
+    pt1               = state.pt1;
+    pt2               = state.pt2;
+    m_animation_clip  = (AnimationClipId)state.animation_clip;
+
+    m_is_jumping      = state.is_jumping;
+    m_contacts        = state.contacts;
 }
 
-bool Entity::check_collision(Entity* other)
+#ifndef HEADLESS
+void Entity::render(SpriteInstances* sprites, float interpolation)
+{
+    // The world only hands over live entities, but a dead one draws nothing either way
+    if (!is_active()) return;
+
+    const BodyStore& bodies = *m_bodies;
+    float x = bodies.previous_x[m_body] + (bodies.position_x[m_body] - bodies.previous_x[m_body]) * interpolation;
+    float y = bodies.previous_y[m_body] + (bodies.position_y[m_body] - bodies.previous_y[m_body]) * interpolation;
+
+    // Sprites are a unit square whatever the body's size, and without a clip
+    // they show their sheet's first cell
+    int cell = m_animation_clip != NO_CLIP ? get_animation_clip(m_animation_clip).cells[m_animation_index] : 0;
+    int frame = m_sheet_frame + cell;
+
+    sprites->add(m_texture_id, x, y, 1.0f, 1.0f, frame);
+}
+#endif
+
+bool Entity::check_collision(Entity* other) const
 {
     if (other == this) return false;
     // If either entity is inactive, there shouldn't be any collision
-    if (!m_is_active || !other->m_is_active) return false;
+    if (!is_active() || !other->is_active()) return false;
 
-    float x_distance = fabs(m_position.x - other->m_position.x) - ((m_width + other->m_width) / 2.0f);
-    float y_distance = fabs(m_position.y - other->m_position.y) - ((m_height + other->m_height) / 2.0f);
+    const BodyStore& bodies = *m_bodies;
+    int a = m_body, b = other->m_body;
 
-    if (x_distance < 0.0f && y_distance < 0.0f) {
-        set_collided(other);
-    }
+    float x_distance = fabs(bodies.position_x[a] - bodies.position_x[b]) - (bodies.half_width[a] + bodies.half_width[b]);
+    float y_distance = fabs(bodies.position_y[a] - bodies.position_y[b]) - (bodies.half_height[a] + bodies.half_height[b]);
 
     return x_distance < 0.0f && y_distance < 0.0f;
 }
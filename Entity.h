@@ -1,141 +1,220 @@
+#pragma once
+
+#ifdef HEADLESS
+// The headless build has no GL headers; texture ids are just numbers there
+typedef unsigned int GLuint;
+#else
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+#define GL_GLEXT_PROTOTYPES 1
+#include <SDL_opengl.h>
+#endif
+
+#include "AnimationClips.h"
+#include "BodyStore.h"
+#include "ContactBuffer.h"
+#include "EntityTable.h"
+#include "Perception.h"
+
+class SpriteInstances;
+class StaticMap;
+
 enum EntityType { PLATFORM, PLAYER, ENEMY   };
-enum AIType     { WALKER, GUARD, JUMPER, RUNNER, PATROLLER     };
+enum AIType     { WALKER, GUARD, JUMPER, RUNNER, PATROLLER, AI_TYPE_COUNT };
 enum AIState    { WALKING, RUNNING, IDLE, ATTACKING, PATROL };
 
+// Which sides of an entity its last collision passes stopped it on, as bits
+enum ContactSide { CONTACT_TOP = 1, CONTACT_BOTTOM = 2, CONTACT_LEFT = 4, CONTACT_RIGHT = 8 };
+
+// One specialisation per AIType, in AIPolicies.h
+template <AIType TYPE> struct AIPolicy;
+
+// ––––– SNAPSHOTS ––––– //
+// Everything about an entity that changes from tick to tick and doesn't live
+// in the BodyStore, as plain data, so a whole world's worth can be copied
+// into a rewind snapshot in one go. Other entities are kept as handles.
+struct EntityState
+{
+    float movement_x, movement_y, movement_z;
+    float animation_time;
+    int   animation_index;
+    int   animation_clip;       // an AnimationClipId, NO_CLIP for none
+    int   still_ticks;
+    int   ai_state;
+
+    // Set once per spawn, but a slot can be respawned as a different enemy
+    int   ai_type;
+    float speed, jumping_power;
+    float pt1, pt2;
+
+    bool  is_jumping;
+    unsigned char contacts;  // ContactSide bits
+    bool  padding[2];  // spelled out so every byte of a snapshot is written
+};
+
 class Entity
 {
 private:
-    bool m_is_active = true;
+    // The policies are the enemy AI, so they get at its movement and state
+    // the way the ai_* methods used to
+    template <AIType TYPE> friend struct AIPolicy;
 
-    // ––––– ANIMATION ––––– //
-    int* m_animation_right = NULL, // move to the right
-        * m_animation_left = NULL, // move to the left
-        * m_animation_up   = NULL, // move upwards
-        * m_animation_down = NULL; // move downwards
+    // Everything begin_update reads or writes comes first, through the
+    // animation clip, so with tens of thousands of enemies the AI and
+    // steering pass touches as few cache lines of each as it can. What only
+    // collisions, sleeping or rendering use goes after.
 
     // ––––– PHYSICS (GRAVITY) ––––– //
-    glm::vec3 m_position;
-    glm::vec3 m_velocity;
-    glm::vec3 m_acceleration;
+    // Position, velocity, acceleration, size and the active flag live in the
+    // world's BodyStore; the entity just remembers which row is its own
+    BodyStore* m_bodies = nullptr;
+    int        m_body   = -1;
 
     // ————— TRANSFORMATIONS ————— //
     float     m_speed;
     glm::vec3 m_movement;
-    glm::mat4 m_model_matrix;
 
 
     // ————— ENEMY AI ————— //
     EntityType m_entity_type;
     AIType     m_ai_type;
-    AIState    m_ai_state;
-
-    float m_width = 1;
-    float m_height = 1;
+    AIState    m_ai_state = IDLE;
 
+    // ––––– PHYSICS (COLLISIONS) ––––– //
+    // Only the sides are kept on the entity, for its own jumping and
+    // sleeping; what it ran into goes out as contacts instead, to whoever
+    // attached a buffer for them (m_contact_buffer, below). Static geometry
+    // has no handle, so its contacts have NO_ENTITY for the other entity.
+    unsigned char m_contacts = 0;
 
 public:
+    // ––––– PHYSICS (JUMPING) ––––– //
+    bool  m_is_jumping = false;
+    float m_jumping_power = 0;
+
     // ————— STATIC VARIABLES ————— //
     static const int SECONDS_PER_FRAME = 4;
-    static const int    LEFT = 0,
-                        RIGHT = 1,
-                        UP = 2,
-                        DOWN = 3;
     float pt1 = -2.0f;
     float pt2 = -4.0f;
 
     // ————— ANIMATION ————— //
-    int** m_walking = new int* [4]
-        {
-            m_animation_left,
-            m_animation_right,
-            m_animation_up,
-            m_animation_down
-        };
-
-    int m_animation_frames = 0,
-        m_animation_index = 0,
-        m_animation_cols = 0,
-        m_animation_rows = 0;
-
-    int*    m_animation_indices = NULL;
-    float   m_animation_time = 0.0f;
+    // The clip itself is shared (see AnimationClips.h); only where this
+    // entity is in it is its own
+    AnimationClipId m_animation_clip  = NO_CLIP;
+    int             m_animation_index = 0;
+    float           m_animation_time  = 0.0f;
 
-    // ––––– PHYSICS (JUMPING) ––––– //
-    bool  m_is_jumping = false;
-    float m_jumping_power = 0;
+private:
+    ContactBuffer* m_contact_buffer = nullptr;
 
-    // ––––– PHYSICS (COLLISIONS) ––––– //
-    bool m_collided_top = false;
-    bool m_collided_bottom = false;
-    bool m_collided_left = false;
-    bool m_collided_right = false;
-    
-    bool top_enemy = false;
-    bool left_enemy = false;
-    bool right_enemy = false;
-    bool bottom_enemy = false;
+    // Push out of a box the body is overlapping, against its velocity
+    void resolve_y(float other_y, float other_half_height, EntityHandle other);
+    void resolve_x(float other_x, float other_half_width, EntityHandle other);
 
-    bool collided_player = false;
+    // What begin_update does either side of the AI
+    void clear_contacts();
+    void animate_and_steer(float delta_time);
 
-    Entity* collided = nullptr;
+    // Put the body at stop_position, zero its velocity on that axis, record
+    // which side it hit and emit the contact
+    void stop_y(float stop_position_y, bool moving_up, EntityHandle other);
+    void stop_x(float stop_position_x, bool moving_right, EntityHandle other);
+
+public:
+    // ––––– SLEEPING ––––– //
+    int m_still_ticks = 0;  // ticks in a row spent resting on something
+
+    EntityHandle m_handle = NO_ENTITY;  // this entity's own, for others' contacts
 
     GLuint    m_texture_id;
+    int       m_sheet_frame = 0;  // its sheet's first frame in the TextureAtlas; clip cells count from here
 
     // ————— METHODS ————— //
     Entity();
-    ~Entity();
 
-    void draw_sprite_from_texture_atlas(ShaderProgram* program, GLuint texture_id, int index);
-    void update(float delta_time, Entity* player, Entity* collidable_entities, int collidable_entity_count);
-    void render(ShaderProgram* program);
-
-    bool check_collision(Entity* other);
-    void const check_collision_y(Entity* collidable_entities, int collidable_entity_count);
-    void const check_collision_x(Entity* collidable_entities, int collidable_entity_count);
+    // An entity is its row in the BodyStore, so a copy would be a second
+    // entity moving the same body
+    Entity(const Entity&) = delete;
+    Entity& operator=(const Entity&) = delete;
+
+    void attach_body(BodyStore* bodies, int body) { m_bodies = bodies; m_body = body; };
+    void attach_handle(EntityHandle handle)       { m_handle = handle; };
+    void attach_contacts(ContactBuffer* contacts) { m_contact_buffer = contacts; };  // nullptr for none
+
+    // update() runs every phase for this one entity. The world runs the same
+    // phases batched instead: begin_update on everyone, one integrate pass
+    // per axis over the BodyStore with the collisions in between, then
+    // end_update on everyone.
+    void update(float delta_time, Entity* player, Entity** collidable_entities, int collidable_entity_count);
+    void begin_update(float delta_time, const Perception& perception);  // perception only matters to enemies
+    void begin_update(float delta_time);  // everything but the AI: the player, and enemies the AI scheduler skipped
+    // The same for a live enemy already known to be of this type, with its
+    // policy called directly; defined in AIPolicies.h
+    template <AIType TYPE>
+    void begin_update(float delta_time, const Perception& perception);
+    void end_update();
+    void update_sleep();  // after end_update: count resting ticks and fall asleep after enough
+    void wake();
+    // Adds this entity's sprite to the frame's instances, at the blend of
+    // where the body was before the last step and where it is now;
+    // interpolation 1 is the current position
+    void render(SpriteInstances* sprites, float interpolation = 1.0f);
+
+    bool check_collision(Entity* other) const;  // overlap test only; the check_collision_* passes emit contacts
+    void const check_collision_y(Entity** collidable_entities, int collidable_entity_count);
+    void const check_collision_x(Entity** collidable_entities, int collidable_entity_count);
+    void const check_static_collision_y(const StaticMap& map);
+    void const check_static_collision_x(const StaticMap& map);
 
     void move_left()    { m_movement.x = -1.0f; };
     void move_right()   { m_movement.x = 1.0f; };
     void move_up()      { m_movement.y = 1.0f; };
     void move_down()    { m_movement.y = -1.0f; };
 
-    void ai_activate(Entity* player);
-    void ai_walk();
-    void ai_guard(Entity* player);
-    void ai_patrol(Entity* player, float pt1, float pt2);
-    void ai_jump();
-    void ai_run(Entity* player);
+    // Where the player is relative to this entity, for when there's no
+    // world-wide perception pass to read it from
+    Perception perceive(const Entity* player) const;
+
+    void ai_activate(const Perception& perception);  // runs this enemy's AIPolicy
 
-    void activate() { m_is_active = true; };
-    void deactivate() {
-        m_is_active = false;
-        m_model_matrix = glm::translate(m_model_matrix, glm::vec3(100.0f, 100.0f, 0.0f));
-    };
+    // Enemies come and go through the world's spawn_enemy and despawn_enemy,
+    // which keep the pool's live list in step; these only flip the body
+    void activate()   { m_bodies->active[m_body] = 1.0f; };
+    void deactivate() { m_bodies->active[m_body] = 0.0f; };
 
-    void set_collided(Entity* collidable) { collided = collidable; }
+    // Copy this entity's tick-to-tick state out to plain data and back
+    void save_state(EntityState& state) const;
+    void load_state(const EntityState& state);
 
     // ————— GETTERS ————— //
     EntityType const get_entity_type()    const { return m_entity_type;     };
     AIType     const get_ai_type()        const { return m_ai_type;         };
     AIState    const get_ai_state()       const { return m_ai_state;        };
-    glm::vec3  const get_position()       const { return m_position;        };
-    glm::vec3  const get_movement()       const { return m_movement;        };
-    glm::vec3  const get_velocity()       const { return m_velocity;        };
-    glm::vec3  const get_acceleration()   const { return m_acceleration;    };
-    float      const get_jumping_power()  const { return m_jumping_power;   };
-    float      const get_speed()          const { return m_speed;           };
-    int        const get_width()          const { return m_width;           };
-    int        const get_height()         const { return m_height;          };
+    glm::vec3  const get_position()       const { return glm::vec3(m_bodies->position_x[m_body], m_bodies->position_y[m_body], 0.0f);         };
+    glm::vec3  const get_movement()       const { return m_movement;                                                                         };
+    glm::vec3  const get_velocity()       const { return glm::vec3(m_bodies->velocity_x[m_body], m_bodies->velocity_y[m_body], 0.0f);         };
+    glm::vec3  const get_acceleration()   const { return glm::vec3(m_bodies->acceleration_x[m_body], m_bodies->acceleration_y[m_body], 0.0f); };
+    float      const get_jumping_power()  const { return m_jumping_power;                                                                    };
+    float      const get_speed()          const { return m_speed;                                                                            };
+    float      const get_width()          const { return m_bodies->half_width[m_body] * 2.0f;                                                };
+    float      const get_height()         const { return m_bodies->half_height[m_body] * 2.0f;                                               };
+    bool       const is_active()          const { return m_bodies->active[m_body] != 0.0f;                                                   };
+    bool       const is_asleep()          const { return m_bodies->asleep[m_body] != 0;                                                      };
+    int        const get_body()           const { return m_body;                                                                             };
+    EntityHandle const get_handle()       const { return m_handle;                                                                           };
+    bool       const has_contact(ContactSide side) const { return (m_contacts & side) != 0;                                                  };
 
     // ————— SETTERS ————— //
     void const set_entity_type(EntityType new_entity_type)  { m_entity_type = new_entity_type;      };
     void const set_ai_type(AIType new_ai_type)              { m_ai_type = new_ai_type;              };
-    void const set_ai_state(AIState new_state)              { m_ai_state = new_state;               };
-    void const set_position(glm::vec3 new_position)         { m_position = new_position;            };
-    void const set_movement(glm::vec3 new_movement)         { m_movement = new_movement;            };
-    void const set_velocity(glm::vec3 new_velocity)         { m_velocity = new_velocity;            };
-    void const set_speed(float new_speed)                   { m_speed = new_speed;                  };
-    void const set_jumping_power(float new_jumping_power)   { m_jumping_power = new_jumping_power;  };
-    void const set_acceleration(glm::vec3 new_acceleration) { m_acceleration = new_acceleration;    };
-    void const set_width(float new_width)                   { m_width = new_width;                  };
-    void const set_height(float new_height)                 { m_height = new_height;                };
+    void const set_ai_state(AIState new_state)              { if (new_state != m_ai_state) wake();  m_ai_state = new_state; };
+    void const set_position(glm::vec3 new_position)         { m_bodies->place(m_body, new_position.x, new_position.y);                                                      };
+    void const set_movement(glm::vec3 new_movement)         { m_movement = new_movement;                                                                                    };
+    void const set_velocity(glm::vec3 new_velocity)         { m_bodies->velocity_x[m_body] = new_velocity.x;         m_bodies->velocity_y[m_body] = new_velocity.y;         };
+    void const set_speed(float new_speed)                   { m_speed = new_speed;                                                                                          };
+    void const set_jumping_power(float new_jumping_power)   { m_jumping_power = new_jumping_power;                                                                          };
+    void const set_acceleration(glm::vec3 new_acceleration) { m_bodies->acceleration_x[m_body] = new_acceleration.x; m_bodies->acceleration_y[m_body] = new_acceleration.y; };
+    void const set_width(float new_width)                   { m_bodies->half_width[m_body] = new_width / 2.0f;                                                              };
+    void const set_height(float new_height)                 { m_bodies->half_height[m_body] = new_height / 2.0f;                                                            };
 };
@@ -0,0 +1,76 @@
+#include <cstring>
+#include "EntityPool.h"
+
+void EntityPool::reset(int capacity, int live_count)
+{
+    m_live.assign(capacity, 0);
+    m_live_position.assign(capacity, -1);
+    m_free.assign(capacity, 0);
+
+    m_live_count = live_count;
+    for (int slot = 0; slot < live_count; slot++)
+    {
+        m_live[slot] = slot;
+        m_live_position[slot] = slot;
+    }
+
+    m_free_count = capacity - live_count;
+    for (int i = 0; i < m_free_count; i++) m_free[i] = capacity - 1 - i;
+}
+
+int EntityPool::spawn()
+{
+    if (m_free_count == 0) return -1;
+
+    int slot = m_free[--m_free_count];
+    m_live_position[slot] = m_live_count;
+    m_live[m_live_count++] = slot;
+
+    return slot;
+}
+
+void EntityPool::despawn(int slot)
+{
+    int position = m_live_position[slot];
+    if (position < 0) return;
+
+    int last = m_live[--m_live_count];
+    m_live[position] = last;
+    m_live_position[last] = position;
+
+    m_live_position[slot] = -1;
+    m_free[m_free_count++] = slot;
+}
+
+void EntityPool::write_snapshot(unsigned char* snapshot) const
+{
+    // Past the counts, the arrays' unused tails are whatever they were; the
+    // caller's snapshot only has to come out the same for the same state,
+    // so they're written as zeros instead
+    int capacity = (int)m_live_position.size();
+    int counts[] = { m_live_count, m_free_count };
+
+    memcpy(snapshot, counts, sizeof(counts));
+    snapshot += sizeof(counts);
+
+    memset(snapshot, 0, 2 * capacity * sizeof(int));
+    memcpy(snapshot, m_live.data(), m_live_count * sizeof(int));
+    memcpy(snapshot + capacity * sizeof(int), m_free.data(), m_free_count * sizeof(int));
+}
+
+void EntityPool::read_snapshot(const unsigned char* snapshot)
+{
+    int capacity = (int)m_live_position.size();
+    int counts[2];
+
+    memcpy(counts, snapshot, sizeof(counts));
+    snapshot += sizeof(counts);
+
+    m_live_count = counts[0];
+    m_free_count = counts[1];
+    memcpy(m_live.data(), snapshot, m_live_count * sizeof(int));
+    memcpy(m_free.data(), snapshot + capacity * sizeof(int), m_free_count * sizeof(int));
+
+    for (int slot = 0; slot < capacity; slot++) m_live_position[slot] = -1;
+    for (int i = 0; i < m_live_count; i++) m_live_position[m_live[i]] = i;
+}
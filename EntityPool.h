@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Which slots of a fixed-size entity array are in use. Free slots sit on a
+// stack, so spawning pops one and despawning pushes it back, and the live
+// ones are kept packed in one dense list, so every loop over them visits
+// exactly the live ones and a dead entity costs nothing. Despawning swaps
+// the last live slot into the gap, so it's O(1) as well; the list's order is
+// part of the state and goes into snapshots with it.
+//
+// Everything is sized in reset(), so spawning and despawning never touch
+// the heap.
+class EntityPool
+{
+private:
+    std::vector<int> m_live;           // live slots, packed
+    std::vector<int> m_live_position;  // per slot, where it is in m_live, or -1 while free
+    std::vector<int> m_free;           // free slots, the next one to spawn into last
+    int m_live_count = 0;
+    int m_free_count = 0;
+
+public:
+    // ————— METHODS ————— //
+    // Slots [0, live_count) start live, in order, and the rest free, with
+    // the lowest spawned into first
+    void reset(int capacity, int live_count);
+
+    int  spawn();              // the slot taken, or -1 if the pool is full
+    void despawn(int slot);    // does nothing for a free slot
+
+    // The live list and the free stack, as two counts and then both arrays
+    // padded out to the capacity, so the size never changes
+    size_t get_snapshot_size() const { return (2 + 2 * m_live_position.size()) * sizeof(int); };
+    void   write_snapshot(unsigned char* snapshot) const;
+    void   read_snapshot(const unsigned char* snapshot);
+
+    // ————— GETTERS ————— //
+    const int* get_live()       const { return m_live.data();           };
+    int  const get_live_count() const { return m_live_count;            };
+    int  const get_capacity()   const { return (int)m_live_position.size(); };
+    bool const is_live(int slot) const { return m_live_position[slot] >= 0; };
+};
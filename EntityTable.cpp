@@ -0,0 +1,48 @@
+#include "EntityTable.h"
+
+void EntityTable::clear()
+{
+    m_slots.clear();
+    m_first_free = -1;
+    m_live_count = 0;
+}
+
+EntityHandle EntityTable::create(Entity* entity)
+{
+    int index;
+    if (m_first_free >= 0)
+    {
+        index = m_first_free;
+        m_first_free = m_slots[index].next_free;
+    }
+    else
+    {
+        index = (int)m_slots.size();
+        Slot slot = { nullptr, 0, -1 };
+        m_slots.push_back(slot);
+    }
+
+    // Generations skip 0 when they wrap, so NO_ENTITY never comes to life
+    Slot& slot = m_slots[index];
+    slot.entity = entity;
+    slot.generation = slot.generation + 1 == 0 ? 1 : slot.generation + 1;
+    slot.next_free = -1;
+    m_live_count++;
+
+    EntityHandle handle = { (unsigned int)index, slot.generation };
+    return handle;
+}
+
+void EntityTable::destroy(EntityHandle handle)
+{
+    if (get(handle) == nullptr) return;
+
+    // Moving the generation on now, not on reuse, is what makes the old
+    // handles stale straight away
+    Slot& slot = m_slots[handle.index];
+    slot.entity = nullptr;
+    slot.generation = slot.generation + 1 == 0 ? 1 : slot.generation + 1;
+    slot.next_free = m_first_free;
+    m_first_free = (int)handle.index;
+    m_live_count--;
+}
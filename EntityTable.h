@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+
+class Entity;
+
+// A reference to an entity that can tell when it's gone stale. The index
+// picks a slot in the world's EntityTable and the generation has to match
+// the slot's: a despawned entity's slot moves on to the next generation, so
+// handles to it stop resolving instead of pointing at whatever reuses it.
+// Plain data, so it goes into snapshots as it is.
+struct EntityHandle
+{
+    unsigned int index;
+    unsigned int generation;  // 0 is never handed out, so a zeroed handle is no entity
+};
+
+const EntityHandle NO_ENTITY = { 0, 0 };
+
+inline bool operator==(EntityHandle a, EntityHandle b) { return a.index == b.index && a.generation == b.generation; }
+inline bool operator!=(EntityHandle a, EntityHandle b) { return !(a == b); }
+
+// Every live entity's slot. Creating takes a slot off the free list, or a
+// new one, and destroying puts it back with its generation moved on, so both
+// and every lookup are O(1).
+class EntityTable
+{
+private:
+    struct Slot
+    {
+        Entity*      entity;
+        unsigned int generation;
+        int          next_free;  // the free list runs through the empty slots
+    };
+
+    std::vector<Slot> m_slots;
+    int m_first_free = -1;
+    int m_live_count = 0;
+
+public:
+    // ————— METHODS ————— //
+    void reserve(int count) { m_slots.reserve(count); };
+    void clear();
+
+    EntityHandle create(Entity* entity);
+    void         destroy(EntityHandle handle);  // does nothing for a stale handle
+
+    // The entity, or nullptr if the handle is stale or NO_ENTITY
+    Entity* get(EntityHandle handle) const
+    {
+        if (handle.index >= m_slots.size()) return nullptr;
+
+        const Slot& slot = m_slots[handle.index];
+        return slot.generation == handle.generation ? slot.entity : nullptr;
+    };
+
+    // ————— GETTERS ————— //
+    int const get_live_count() const { return m_live_count;          };
+    int const get_slot_count() const { return (int)m_slots.size();   };
+};
@@ -0,0 +1,220 @@
+#include <cmath>
+#include "FlowField.h"
+
+int const FlowField::cell_at(float x, float y) const
+{
+    if (m_columns == 0) return -1;
+
+    int column = (int)std::floor((x - m_origin_x) * m_inverse_cell_size);
+    int row    = (int)std::floor((y - m_origin_y) * m_inverse_cell_size);
+
+    // Anything above the grid is above open sky and falls into the top row
+    if (column < 0 || column >= m_columns || row < 0) return -1;
+    if (row >= m_rows) row = m_rows - 1;
+
+    return row * m_columns + column;
+}
+
+void FlowField::clear()
+{
+    m_columns = 0;
+    m_rows = 0;
+    m_walkable_count = 0;
+    m_landing.clear();
+    m_moves.clear();
+    m_arrival_starts.clear();
+    m_arrivals.clear();
+    m_distances.clear();
+    m_queue.clear();
+    m_steps.clear();
+    m_target = -1;
+    m_rebuild_count = 0;
+}
+
+void FlowField::bake(const StaticMap& map, float cell_size)
+{
+    clear();
+
+    int box_count = map.get_box_count();
+    if (box_count == 0) return;
+
+    m_cell_size = cell_size;
+    m_inverse_cell_size = 1.0f / cell_size;
+
+    // STEP 1: Cells are centred on the lowest, leftmost box centre's lattice,
+    // so platforms laid out a cell apart each fill one cell, with a cell of
+    // slack on every side
+    const StaticBox& first = map.get_box(0);
+    float anchor_x = first.center_x, min_x = first.center_x - first.half_width, max_x = first.center_x + first.half_width;
+    float anchor_y = first.center_y, min_y = first.center_y - first.half_height, max_y = first.center_y + first.half_height;
+
+    for (int i = 1; i < box_count; i++)
+    {
+        const StaticBox& box = map.get_box(i);
+        anchor_x = std::fmin(anchor_x, box.center_x);
+        anchor_y = std::fmin(anchor_y, box.center_y);
+        min_x = std::fmin(min_x, box.center_x - box.half_width);
+        max_x = std::fmax(max_x, box.center_x + box.half_width);
+        min_y = std::fmin(min_y, box.center_y - box.half_height);
+        max_y = std::fmax(max_y, box.center_y + box.half_height);
+    }
+
+    m_origin_x = anchor_x - cell_size * (0.5f + std::floor((anchor_x - min_x) * m_inverse_cell_size) + 1.0f);
+    m_origin_y = anchor_y - cell_size * (0.5f + std::floor((anchor_y - min_y) * m_inverse_cell_size) + 1.0f);
+    m_columns  = (int)std::floor((max_x - m_origin_x) * m_inverse_cell_size) + 2;
+    m_rows     = (int)std::floor((max_y - m_origin_y) * m_inverse_cell_size) + 2;
+
+    int cell_count = m_columns * m_rows;
+
+    // STEP 2: A cell is solid if a box covers any of its middle half, so a
+    // thin platform marks the one cell it sits in and not its neighbours
+    std::vector<unsigned char> solid(cell_count, 0);
+    float quarter = cell_size * 0.25f;
+
+    for (int i = 0; i < box_count; i++)
+    {
+        const StaticBox& box = map.get_box(i);
+        int first_column = (int)std::floor((box.center_x - box.half_width - m_origin_x) * m_inverse_cell_size);
+        int last_column  = (int)std::floor((box.center_x + box.half_width - m_origin_x) * m_inverse_cell_size);
+        int first_row    = (int)std::floor((box.center_y - box.half_height - m_origin_y) * m_inverse_cell_size);
+        int last_row     = (int)std::floor((box.center_y + box.half_height - m_origin_y) * m_inverse_cell_size);
+
+        for (int row = first_row; row <= last_row; row++)
+        {
+            float middle_y = m_origin_y + (row + 0.5f) * cell_size;
+            if (middle_y - quarter >= box.center_y + box.half_height || middle_y + quarter <= box.center_y - box.half_height) continue;
+
+            for (int column = first_column; column <= last_column; column++)
+            {
+                float middle_x = m_origin_x + (column + 0.5f) * cell_size;
+                if (middle_x - quarter >= box.center_x + box.half_width || middle_x + quarter <= box.center_x - box.half_width) continue;
+
+                solid[row * m_columns + column] = 1;
+            }
+        }
+    }
+
+    // STEP 3: Where everything lands, bottom row up so the cell underneath
+    // is always done first
+    m_landing.assign(cell_count, -1);
+
+    for (int row = 1; row < m_rows; row++)
+    {
+        for (int column = 0; column < m_columns; column++)
+        {
+            int cell = row * m_columns + column;
+            if (solid[cell]) continue;
+
+            int below = cell - m_columns;
+            if (solid[below])
+            {
+                m_landing[cell] = cell;
+                m_walkable_count++;
+            }
+            else m_landing[cell] = m_landing[below];
+        }
+    }
+
+    // STEP 4: Each walkable cell's two moves, then the same moves reversed as
+    // per-cell lists, which is what the search walks
+    m_moves.assign(cell_count * 2, -1);
+    m_arrival_starts.assign(cell_count + 1, 0);
+
+    for (int cell = 0; cell < cell_count; cell++)
+    {
+        if (m_landing[cell] != cell) continue;
+
+        int column = cell % m_columns;
+        if (column > 0             && !solid[cell - 1]) m_moves[cell * 2]     = m_landing[cell - 1];
+        if (column < m_columns - 1 && !solid[cell + 1]) m_moves[cell * 2 + 1] = m_landing[cell + 1];
+
+        for (int side = 0; side < 2; side++)
+            if (m_moves[cell * 2 + side] >= 0) m_arrival_starts[m_moves[cell * 2 + side] + 1]++;
+    }
+
+    for (int cell = 0; cell < cell_count; cell++) m_arrival_starts[cell + 1] += m_arrival_starts[cell];
+
+    m_arrivals.resize(m_arrival_starts.back());
+    std::vector<int> cursor(m_arrival_starts.begin(), m_arrival_starts.end() - 1);
+
+    for (int cell = 0; cell < cell_count; cell++)
+        for (int side = 0; side < 2; side++)
+            if (m_landing[cell] == cell && m_moves[cell * 2 + side] >= 0) m_arrivals[cursor[m_moves[cell * 2 + side]]++] = cell;
+
+    // Sized once here, so update() never touches the heap
+    m_distances.assign(cell_count, -1);
+    m_queue.resize(m_walkable_count);
+    m_steps.assign(cell_count, 0);
+}
+
+void FlowField::update(float player_x, float player_y)
+{
+    int cell   = cell_at(player_x, player_y);
+    int target = cell < 0 ? -1 : m_landing[cell];
+
+    if (target == m_target && m_rebuild_count > 0) return;
+
+    m_target = target;
+    search();
+    m_rebuild_count++;
+}
+
+void FlowField::search()
+{
+    int cell_count = m_columns * m_rows;
+    int* distances = m_distances.data();
+    signed char* steps = m_steps.data();
+
+    for (int cell = 0; cell < cell_count; cell++) distances[cell] = -1;
+
+    // STEP 1: Breadth-first from the target along the reversed moves, so
+    // every walkable cell gets its fewest moves to the player
+    if (m_target >= 0)
+    {
+        int* queue = m_queue.data();
+        int  head = 0, tail = 0;
+
+        distances[m_target] = 0;
+        queue[tail++] = m_target;
+
+        while (head < tail)
+        {
+            int cell = queue[head++];
+            for (int i = m_arrival_starts[cell]; i < m_arrival_starts[cell + 1]; i++)
+            {
+                int from = m_arrivals[i];
+                if (distances[from] >= 0) continue;
+
+                distances[from] = distances[cell] + 1;
+                queue[tail++] = from;
+            }
+        }
+    }
+
+    // STEP 2: A walkable cell steps whichever way is one move closer, towards
+    // the target's column if both are. Every other cell steps the way the
+    // cell it lands on does, which is already done as landing cells are
+    // always lower down.
+    int target_column = m_target >= 0 ? m_target % m_columns : 0;
+
+    for (int cell = 0; cell < cell_count; cell++)
+    {
+        int landing = m_landing[cell];
+        if (landing != cell)
+        {
+            steps[cell] = landing < 0 ? 0 : steps[landing];
+            continue;
+        }
+
+        steps[cell] = 0;
+        int distance = distances[cell];
+        if (distance <= 0) continue;
+
+        bool left  = m_moves[cell * 2]     >= 0 && distances[m_moves[cell * 2]]     == distance - 1;
+        bool right = m_moves[cell * 2 + 1] >= 0 && distances[m_moves[cell * 2 + 1]] == distance - 1;
+
+        if (left && right) steps[cell] = target_column < cell % m_columns ? -1 : 1;
+        else if (left)     steps[cell] = -1;
+        else if (right)    steps[cell] = 1;
+    }
+}
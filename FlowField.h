@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+#include "StaticMap.h"
+
+// Which way to walk to reach the player, for every place an enemy can be,
+// shared by every enemy that chases.
+//
+// The static map's boxes are laid over a grid and each cell marked solid or
+// free. A free cell with a solid one underneath is walkable: something can
+// stand there. Walking left or right from one either reaches the next
+// walkable cell along, or steps off a ledge and falls to the walkable cell
+// below, so every walkable cell has at most two moves and enemies, which
+// can't jump, never go up. Every free cell also knows the walkable cell a
+// body in it falls to, so an enemy or player in mid-air counts as wherever
+// it's going to land.
+//
+// update() runs a breadth-first search back from the player's cell along
+// the moves reversed and keeps one step per cell: -1, 1, or 0 where there's
+// no way to the player or it's already there. It only searches again when
+// the player lands in a different cell, and sample() is two array reads, so
+// the cost is the same whether three enemies chase or thirty thousand.
+class FlowField
+{
+private:
+    float m_cell_size = 1.0f;
+    float m_inverse_cell_size = 1.0f;
+    float m_origin_x = 0.0f, m_origin_y = 0.0f;
+    int   m_columns = 0, m_rows = 0;
+    int   m_walkable_count = 0;
+
+    std::vector<int> m_landing;  // per cell, the walkable cell a body here falls to, or -1
+    std::vector<int> m_moves;    // per cell, the walkable cell walking left then right leads to, or -1
+
+    std::vector<int> m_arrival_starts;  // cell c is reached from m_arrivals[starts[c], starts[c + 1])
+    std::vector<int> m_arrivals;
+
+    std::vector<int>         m_distances;  // moves to the target, -1 for no way there
+    std::vector<int>         m_queue;
+    std::vector<signed char> m_steps;      // per cell, which way to walk
+
+    int m_target        = -1;  // the walkable cell the player is on or falling to
+    int m_rebuild_count = 0;
+
+    int  const cell_at(float x, float y) const;
+    void search();
+
+public:
+    // ————— METHODS ————— //
+    void clear();
+
+    // Lays a grid of this cell size over the map's boxes, lined up with their
+    // centres, and works out every cell's moves
+    void bake(const StaticMap& map, float cell_size);
+
+    // Searches again if the player's landing cell has changed since last time
+    void update(float player_x, float player_y);
+
+    // The step for wherever (x, y) is: -1 or 1 to walk that way, 0 for no
+    // better idea than heading straight for the player
+    float const sample(float x, float y) const
+    {
+        int cell = cell_at(x, y);
+        return cell < 0 ? 0.0f : (float)m_steps[cell];
+    };
+
+    // ————— GETTERS ————— //
+    int const get_cell_count()     const { return m_columns * m_rows;  };
+    int const get_walkable_count() const { return m_walkable_count;    };
+    int const get_rebuild_count()  const { return m_rebuild_count;     };
+    int const get_target()         const { return m_target;            };
+};
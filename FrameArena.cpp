@@ -0,0 +1,75 @@
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include "FrameArena.h"
+
+FrameArena::FrameArena(size_t capacity)
+{
+    m_capacity = capacity;
+    m_buffer = static_cast<unsigned char*>(malloc(m_capacity));
+    if (m_buffer == nullptr) throw std::bad_alloc();
+    m_heap_allocations++;
+}
+
+FrameArena::~FrameArena()
+{
+    reset();
+    free(m_buffer);
+}
+
+void* FrameArena::allocate(size_t bytes, size_t alignment)
+{
+    m_frame_bytes += bytes + alignment;
+
+    uintptr_t base    = reinterpret_cast<uintptr_t>(m_buffer);
+    uintptr_t aligned = (base + m_offset + alignment - 1) & ~(uintptr_t)(alignment - 1);
+
+    if (aligned + bytes <= base + m_capacity)
+    {
+        m_offset = aligned + bytes - base;
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    // Out of room this frame: hand out a heap block and remember to grow
+    unsigned char* block = static_cast<unsigned char*>(malloc(sizeof(OverflowBlock) + alignment + bytes));
+    if (block == nullptr) throw std::bad_alloc();
+    m_heap_allocations++;
+
+    OverflowBlock* header = reinterpret_cast<OverflowBlock*>(block);
+    header->next = m_overflow;
+    m_overflow = header;
+
+    uintptr_t start = reinterpret_cast<uintptr_t>(block + sizeof(OverflowBlock));
+    return reinterpret_cast<void*>((start + alignment - 1) & ~(uintptr_t)(alignment - 1));
+}
+
+void FrameArena::reset()
+{
+    while (m_overflow != nullptr)
+    {
+        OverflowBlock* next = m_overflow->next;
+        free(m_overflow);
+        m_overflow = next;
+    }
+
+    if (m_frame_bytes > m_peak_bytes) m_peak_bytes = m_frame_bytes;
+
+    // Grow once so that the biggest frame seen so far fits without spilling
+    if (m_peak_bytes > m_capacity)
+    {
+        size_t capacity = m_capacity > 0 ? m_capacity * 2 : 1024;
+        while (capacity < m_peak_bytes) capacity *= 2;
+
+        unsigned char* buffer = static_cast<unsigned char*>(malloc(capacity));
+        if (buffer != nullptr)
+        {
+            free(m_buffer);
+            m_buffer = buffer;
+            m_capacity = capacity;
+            m_heap_allocations++;
+        }
+    }
+
+    m_offset = 0;
+    m_frame_bytes = 0;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+
+// A bump allocator for data that only lives until the end of the frame: the
+// vertices SpriteBatch bakes and the instances SpriteInstances sorts, which
+// are gone as soon as they're in their GL buffers. Allocating is a pointer
+// bump and nothing is ever freed individually; reset() throws the whole frame
+// away.
+//
+// If a frame asks for more than the buffer holds, the extra requests spill into
+// heap blocks and the buffer is regrown at the next reset, so after a frame or
+// two of warm-up the arena never touches the heap again.
+class FrameArena
+{
+private:
+    struct OverflowBlock
+    {
+        OverflowBlock* next;
+    };
+
+    unsigned char* m_buffer = nullptr;
+    size_t m_capacity = 0;
+    size_t m_offset   = 0;
+
+    OverflowBlock* m_overflow = nullptr;
+    size_t m_frame_bytes = 0;  // everything asked for this frame, including overflow
+    size_t m_peak_bytes  = 0;
+
+    size_t m_heap_allocations = 0;
+
+public:
+    // ————— METHODS ————— //
+    FrameArena(size_t capacity);
+    ~FrameArena();
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* allocate(size_t bytes, size_t alignment);
+    void  reset();
+
+    template <typename T>
+    T* allocate_array(size_t count) { return static_cast<T*>(allocate(sizeof(T) * count, alignof(T))); };
+
+    // ————— GETTERS ————— //
+    size_t const get_capacity()         const { return m_capacity;         };
+    size_t const get_frame_bytes()      const { return m_frame_bytes;      };
+    size_t const get_peak_bytes()       const { return m_peak_bytes;       };
+    size_t const get_heap_allocations() const { return m_heap_allocations; };
+};
@@ -0,0 +1,135 @@
+#include <cstring>
+#include <fstream>
+#include "InputLog.h"
+
+#define INPUT_LOG_MAGIC "P1IN"
+#define INPUT_LOG_VERSION 1
+
+// Plain little helpers for the fixed-size fields around the encoded runs
+template <typename T>
+static void write_field(std::ofstream& file, const T& value) { file.write(reinterpret_cast<const char*>(&value), sizeof(T)); }
+
+template <typename T>
+static bool read_field(std::ifstream& file, T& value) { return (bool)file.read(reinterpret_cast<char*>(&value), sizeof(T)); }
+
+// Seven bits at a time, low first; the top bit says another byte follows
+static void write_varint(std::vector<unsigned char>& bytes, unsigned int value)
+{
+    while (value >= 0x80)
+    {
+        bytes.push_back((unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back((unsigned char)value);
+}
+
+void InputLog::begin(const SceneConfig& scene, float time_step)
+{
+    m_scene     = scene;
+    m_time_step = time_step;
+
+    m_bytes.clear();
+    m_hashes.clear();
+    m_ticks.clear();
+
+    m_current_buttons = 0;
+    m_run_ticks       = 0;
+    m_tick_count      = 0;
+}
+
+void InputLog::record(unsigned char buttons)
+{
+    if (buttons != m_current_buttons)
+    {
+        write_varint(m_bytes, m_run_ticks);
+        m_bytes.push_back(buttons ^ m_current_buttons);
+
+        m_current_buttons = buttons;
+        m_run_ticks = 0;
+    }
+
+    m_run_ticks++;
+    m_tick_count++;
+}
+
+void InputLog::record_hash(unsigned long long hash)
+{
+    m_hashes.push_back(hash);
+}
+
+bool InputLog::save(const char* path)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    // The last run has no change after it, so it ends the stream on its own
+    std::vector<unsigned char> bytes = m_bytes;
+    write_varint(bytes, m_run_ticks);
+
+    file.write(INPUT_LOG_MAGIC, 4);
+    write_field(file, (int)INPUT_LOG_VERSION);
+    write_field(file, (int)m_scene.type);
+    write_field(file, m_scene.platform_count);
+    write_field(file, m_scene.enemy_count);
+    write_field(file, m_scene.seed);
+    write_field(file, m_time_step);
+    write_field(file, m_tick_count);
+
+    write_field(file, (int)bytes.size());
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+
+    write_field(file, (int)m_hashes.size());
+    file.write(reinterpret_cast<const char*>(m_hashes.data()), m_hashes.size() * sizeof(unsigned long long));
+
+    return (bool)file;
+}
+
+bool InputLog::load(const char* path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    char magic[4];
+    int version, type, byte_count, hash_count;
+
+    if (!file.read(magic, 4) || memcmp(magic, INPUT_LOG_MAGIC, 4) != 0) return false;
+    if (!read_field(file, version) || version != INPUT_LOG_VERSION)     return false;
+
+    if (!read_field(file, type) || !read_field(file, m_scene.platform_count) || !read_field(file, m_scene.enemy_count) ||
+        !read_field(file, m_scene.seed) || !read_field(file, m_time_step) || !read_field(file, m_tick_count))
+    {
+        return false;
+    }
+    m_scene.type = (SceneType)type;
+
+    if (!read_field(file, byte_count) || byte_count < 0) return false;
+    m_bytes.resize(byte_count);
+    if (!file.read(reinterpret_cast<char*>(m_bytes.data()), byte_count)) return false;
+
+    if (!read_field(file, hash_count) || hash_count < 0) return false;
+    m_hashes.resize(hash_count);
+    if (!file.read(reinterpret_cast<char*>(m_hashes.data()), hash_count * sizeof(unsigned long long))) return false;
+
+    // Expand the runs back into one entry per tick
+    m_ticks.clear();
+    m_ticks.reserve(m_tick_count);
+
+    unsigned char buttons = 0;
+    size_t at = 0;
+
+    while (at < m_bytes.size())
+    {
+        unsigned int run = 0;
+        for (int shift = 0; at < m_bytes.size(); shift += 7)
+        {
+            unsigned char byte = m_bytes[at++];
+            run |= (unsigned int)(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) break;
+        }
+
+        m_ticks.insert(m_ticks.end(), run, buttons);
+        if (at < m_bytes.size()) buttons ^= m_bytes[at++];
+    }
+
+    return (int)m_ticks.size() == m_tick_count;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+#include "World.h"
+
+// A recording of every tick's player input, plus the hash of the world's
+// state after each of those ticks, so a session can be played back headless
+// and checked tick by tick.
+//
+// Input is stored as runs: how many ticks the buttons stayed the same (a
+// varint, usually one byte) followed by which bits flipped (one byte). A
+// minute of holding right is about three bytes instead of 3600.
+class InputLog
+{
+private:
+    SceneConfig m_scene;
+    float       m_time_step = 0.0f;
+
+    std::vector<unsigned char>      m_bytes;   // the encoded runs
+    std::vector<unsigned long long> m_hashes;  // one per tick
+
+    // ––––– RECORDING ––––– //
+    unsigned char m_current_buttons = 0;
+    unsigned int  m_run_ticks       = 0;
+    int           m_tick_count      = 0;
+
+    // ––––– PLAYBACK ––––– //
+    std::vector<unsigned char> m_ticks;  // decoded buttons, one per tick
+
+public:
+    // ————— METHODS ————— //
+    void begin(const SceneConfig& scene, float time_step);
+    void record(unsigned char buttons);  // once per tick, in order
+    void record_hash(unsigned long long hash);
+
+    bool save(const char* path);  // closes the last run first
+    bool load(const char* path);
+
+    // ————— GETTERS ————— //
+    const SceneConfig&       get_scene()              const { return m_scene;                };
+    float              const get_time_step()          const { return m_time_step;            };
+    int                const get_tick_count()         const { return m_tick_count;           };
+    int                const get_encoded_bytes()      const { return (int)m_bytes.size();    };
+    int                const get_hash_count()         const { return (int)m_hashes.size();   };
+    unsigned char      const get_input(int tick)      const { return m_ticks[tick];          };
+    unsigned long long const get_hash(int tick)       const { return m_hashes[tick];         };
+};
@@ -0,0 +1,147 @@
+#include "JobSystem.h"
+
+// Idle workers spin this many times looking for a new loop before they go to
+// sleep, since the world hands out several loops back to back every tick
+#define JOB_SPIN_COUNT 4096
+
+JobSystem::JobSystem(int thread_count)
+{
+    if (thread_count <= 0) thread_count = (int)std::thread::hardware_concurrency();
+    if (thread_count <= 0) thread_count = 1;
+
+    m_thread_count = thread_count;
+    m_slices.reset(new Slice[thread_count]);
+    for (int i = 0; i < thread_count; i++) m_slices[i].bounds = pack(0, 0);
+
+    m_workers.reserve(thread_count - 1);
+    for (int i = 1; i < thread_count; i++) m_workers.push_back(std::thread(&JobSystem::worker_main, this, i));
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wake.notify_all();
+
+    for (std::thread& worker : m_workers) worker.join();
+}
+
+bool JobSystem::take_own(int thread, int& begin, int& end)
+{
+    std::atomic<uint64_t>& bounds = m_slices[thread].bounds;
+    uint64_t current = bounds.load();
+
+    while (begin_of(current) < end_of(current))
+    {
+        begin = begin_of(current);
+        end   = begin + m_grain < end_of(current) ? begin + m_grain : end_of(current);
+        if (bounds.compare_exchange_weak(current, pack(end, end_of(current)))) return true;
+    }
+
+    return false;
+}
+
+bool JobSystem::steal(int thread)
+{
+    // Rob whoever has the most left; the loop ends when every slice is empty
+    while (true)
+    {
+        int victim = -1;
+        int most   = 0;
+        uint64_t victim_bounds = 0;
+
+        for (int i = 0; i < m_thread_count; i++)
+        {
+            if (i == thread) continue;
+
+            uint64_t bounds = m_slices[i].bounds.load();
+            int left = end_of(bounds) - begin_of(bounds);
+            if (left > most)
+            {
+                victim = i;
+                most = left;
+                victim_bounds = bounds;
+            }
+        }
+
+        if (victim < 0) return false;
+
+        // Take the back half, or all of it if that's less than a grain
+        int begin  = begin_of(victim_bounds);
+        int end    = end_of(victim_bounds);
+        int middle = most <= m_grain ? begin : begin + most / 2;
+
+        if (m_slices[victim].bounds.compare_exchange_strong(victim_bounds, pack(begin, middle)))
+        {
+            // Nobody else touches an empty slice, so a plain store is enough
+            m_slices[thread].bounds.store(pack(middle, end));
+            return true;
+        }
+    }
+}
+
+void JobSystem::work(int thread)
+{
+    int begin, end;
+
+    do
+    {
+        while (take_own(thread, begin, end)) m_function(m_body, begin, end);
+    } while (steal(thread));
+}
+
+void JobSystem::worker_main(int thread)
+{
+    unsigned seen = 0;
+
+    while (true)
+    {
+        for (int spin = 0; spin < JOB_SPIN_COUNT && m_generation.load() == seen; spin++) std::this_thread::yield();
+
+        if (m_generation.load() == seen)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&]() { return m_quit || m_generation.load() != seen; });
+            if (m_quit) return;
+        }
+
+        seen = m_generation.load();
+
+        work(thread);
+        m_busy_workers.fetch_sub(1);
+    }
+}
+
+void JobSystem::run(RangeFunction function, const void* body, int count, int grain)
+{
+    m_function = function;
+    m_body     = body;
+    m_grain    = grain;
+
+    // STEP 1: Even slices, the first few one item longer
+    int share = count / m_thread_count;
+    int extra = count % m_thread_count;
+    int begin = 0;
+
+    for (int i = 0; i < m_thread_count; i++)
+    {
+        int end = begin + share + (i < extra ? 1 : 0);
+        m_slices[i].bounds.store(pack(begin, end));
+        begin = end;
+    }
+
+    // STEP 2: Every worker takes part in every loop and checks out when done,
+    // so nobody is still looking at this loop's slices when the next begins
+    m_busy_workers.store(m_thread_count - 1);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_generation.fetch_add(1);
+    }
+    m_wake.notify_all();
+
+    // STEP 3: Pitch in, then wait for the stragglers
+    work(0);
+    while (m_busy_workers.load() != 0) std::this_thread::yield();
+}
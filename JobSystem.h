@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A small work-stealing pool for data-parallel loops over the world's arrays.
+//
+// parallel_for(count, grain, body) cuts [0, count) into one contiguous slice
+// per thread. Each thread eats its own slice from the front, grain items at a
+// time, and when it runs dry it steals the back half of whichever slice has
+// the most left. The calling thread works too, and only returns once every
+// item is done.
+//
+// Each item is handed to exactly one call of body(begin, end), so as long as
+// body only writes to item i's own state while handling item i, the result is
+// bit-identical to a serial loop no matter how the work was split or stolen.
+class JobSystem
+{
+private:
+    typedef void (*RangeFunction)(const void* body, int begin, int end);
+
+    // [begin, end) packed into one word so owner and thieves can both claim
+    // items with a single compare-and-swap. Padded out to a cache line so
+    // threads working their own slices don't fight over the same line.
+    struct Slice
+    {
+        std::atomic<uint64_t> bounds;
+        char padding[64 - sizeof(std::atomic<uint64_t>)];
+    };
+
+    int m_thread_count = 1;  // including the caller
+    std::vector<std::thread> m_workers;
+    std::unique_ptr<Slice[]> m_slices;
+
+    std::mutex              m_mutex;
+    std::condition_variable m_wake;
+    std::atomic<unsigned>   m_generation{ 0 };
+    std::atomic<int>        m_busy_workers{ 0 };
+    bool                    m_quit = false;
+
+    // The loop being run this generation
+    RangeFunction m_function = nullptr;
+    const void*   m_body     = nullptr;
+    int           m_grain    = 1;
+
+    static uint64_t pack(int begin, int end) { return (uint64_t)(uint32_t)begin | ((uint64_t)(uint32_t)end << 32); };
+    static int      begin_of(uint64_t bounds) { return (int)(uint32_t)bounds;         };
+    static int      end_of(uint64_t bounds)   { return (int)(uint32_t)(bounds >> 32); };
+
+    bool take_own(int thread, int& begin, int& end);
+    bool steal(int thread);
+    void work(int thread);
+    void worker_main(int thread);
+    void run(RangeFunction function, const void* body, int count, int grain);
+
+    template <typename Body>
+    static void call_range(const void* body, int begin, int end) { (*static_cast<const Body*>(body))(begin, end); };
+
+public:
+    // ————— METHODS ————— //
+    // thread_count includes the calling thread; 0 means one per hardware thread
+    JobSystem(int thread_count);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Calls body(begin, end) over disjoint ranges covering [0, count). Loops
+    // no bigger than one grain just run inline on the caller.
+    template <typename Body>
+    void parallel_for(int count, int grain, const Body& body)
+    {
+        if (count <= 0) return;
+        if (m_thread_count == 1 || count <= grain)
+        {
+            body(0, count);
+            return;
+        }
+
+        run(&call_range<Body>, &body, count, grain);
+    };
+
+    // ————— GETTERS ————— //
+    int const get_thread_count() const { return m_thread_count; };
+};
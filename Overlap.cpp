@@ -0,0 +1,103 @@
+#include <cmath>
+#include "Overlap.h"
+
+#if defined(__AVX2__)
+#define OVERLAP_AVX2 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OVERLAP_SSE2 1
+#include <emmintrin.h>
+#endif
+
+int overlap_boxes_scalar(float center_x, float center_y, float half_width, float half_height,
+                         const float* centers_x, const float* centers_y,
+                         const float* half_widths, const float* half_heights,
+                         const float* active, int count, int* hits)
+{
+    int hit_count = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        float x_distance = std::fabs(center_x - centers_x[i]) - (half_width + half_widths[i]);
+        float y_distance = std::fabs(center_y - centers_y[i]) - (half_height + half_heights[i]);
+
+        // Always write, only advance on a hit: no branch to mispredict
+        hits[hit_count] = i;
+        hit_count += (x_distance < 0.0f && y_distance < 0.0f && active[i] != 0.0f) ? 1 : 0;
+    }
+
+    return hit_count;
+}
+
+int overlap_boxes(float center_x, float center_y, float half_width, float half_height,
+                  const float* centers_x, const float* centers_y,
+                  const float* half_widths, const float* half_heights,
+                  const float* active, int count, int* hits)
+{
+    int hit_count = 0;
+    int i = 0;
+
+#if defined(OVERLAP_AVX2)
+    const __m256 sign_bit = _mm256_set1_ps(-0.0f);
+    const __m256 zero     = _mm256_setzero_ps();
+    const __m256 query_x  = _mm256_set1_ps(center_x);
+    const __m256 query_y  = _mm256_set1_ps(center_y);
+    const __m256 query_hw = _mm256_set1_ps(half_width);
+    const __m256 query_hh = _mm256_set1_ps(half_height);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 x_distance = _mm256_sub_ps(_mm256_andnot_ps(sign_bit, _mm256_sub_ps(query_x, _mm256_loadu_ps(centers_x + i))),
+                                          _mm256_add_ps(query_hw, _mm256_loadu_ps(half_widths + i)));
+        __m256 y_distance = _mm256_sub_ps(_mm256_andnot_ps(sign_bit, _mm256_sub_ps(query_y, _mm256_loadu_ps(centers_y + i))),
+                                          _mm256_add_ps(query_hh, _mm256_loadu_ps(half_heights + i)));
+
+        __m256 overlap = _mm256_and_ps(_mm256_cmp_ps(x_distance, zero, _CMP_LT_OQ), _mm256_cmp_ps(y_distance, zero, _CMP_LT_OQ));
+        overlap = _mm256_and_ps(overlap, _mm256_cmp_ps(_mm256_loadu_ps(active + i), zero, _CMP_NEQ_OQ));
+
+        int mask = _mm256_movemask_ps(overlap);
+        if (mask == 0) continue;
+
+        for (int lane = 0; lane < 8; lane++)
+        {
+            hits[hit_count] = i + lane;
+            hit_count += (mask >> lane) & 1;
+        }
+    }
+#elif defined(OVERLAP_SSE2)
+    const __m128 sign_bit = _mm_set1_ps(-0.0f);
+    const __m128 zero     = _mm_setzero_ps();
+    const __m128 query_x  = _mm_set1_ps(center_x);
+    const __m128 query_y  = _mm_set1_ps(center_y);
+    const __m128 query_hw = _mm_set1_ps(half_width);
+    const __m128 query_hh = _mm_set1_ps(half_height);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 x_distance = _mm_sub_ps(_mm_andnot_ps(sign_bit, _mm_sub_ps(query_x, _mm_loadu_ps(centers_x + i))),
+                                       _mm_add_ps(query_hw, _mm_loadu_ps(half_widths + i)));
+        __m128 y_distance = _mm_sub_ps(_mm_andnot_ps(sign_bit, _mm_sub_ps(query_y, _mm_loadu_ps(centers_y + i))),
+                                       _mm_add_ps(query_hh, _mm_loadu_ps(half_heights + i)));
+
+        __m128 overlap = _mm_and_ps(_mm_cmplt_ps(x_distance, zero), _mm_cmplt_ps(y_distance, zero));
+        overlap = _mm_and_ps(overlap, _mm_cmpneq_ps(_mm_loadu_ps(active + i), zero));
+
+        int mask = _mm_movemask_ps(overlap);
+        if (mask == 0) continue;
+
+        for (int lane = 0; lane < 4; lane++)
+        {
+            hits[hit_count] = i + lane;
+            hit_count += (mask >> lane) & 1;
+        }
+    }
+#endif
+
+    // Whatever didn't fill a whole vector
+    int tail_count = overlap_boxes_scalar(center_x, center_y, half_width, half_height,
+                                          centers_x + i, centers_y + i, half_widths + i, half_heights + i,
+                                          active + i, count - i, hits + hit_count);
+    for (int j = 0; j < tail_count; j++) hits[hit_count + j] += i;
+
+    return hit_count + tail_count;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+// Tests one box against count packed boxes (one array per field, like the
+// BodyStore) and writes the index of every box it strictly overlaps into
+// hits, in increasing order. Boxes whose active entry is 0 are skipped.
+// Returns how many hits there were; hits needs room for count of them.
+//
+// Uses the same test as Entity::check_collision, |distance| - combined half
+// extents < 0 on both axes, and has no side effects. Runs 8 boxes at a time
+// with AVX2, 4 with SSE2, and falls back to scalar code without either.
+int overlap_boxes(float center_x, float center_y, float half_width, float half_height,
+                  const float* centers_x, const float* centers_y,
+                  const float* half_widths, const float* half_heights,
+                  const float* active, int count, int* hits);
+
+// The plain one-box-at-a-time version, kept for the tail of the SIMD loops
+// and so the benchmark has something to compare against
+int overlap_boxes_scalar(float center_x, float center_y, float half_width, float half_height,
+                         const float* centers_x, const float* centers_y,
+                         const float* half_widths, const float* half_heights,
+                         const float* active, int count, int* hits);
@@ -0,0 +1,14 @@
+#include "Perception.h"
+
+void perceive_point(float point_x, float point_y, const float* positions_x, const float* positions_y, int count,
+                    float* distances_squared, float* offsets_x)
+{
+    for (int i = 0; i < count; i++)
+    {
+        float offset_x = positions_x[i] - point_x;
+        float offset_y = positions_y[i] - point_y;
+
+        distances_squared[i] = offset_x * offset_x + offset_y * offset_y;
+        offsets_x[i]         = offset_x;
+    }
+}
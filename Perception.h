@@ -0,0 +1,21 @@
+#pragma once
+
+// What an enemy's AI knows about the player on a given tick. The world works
+// this out for every enemy in one sweep before any AI runs, so the state
+// machines only compare numbers and never go looking at the player.
+//
+// Distances stay squared: every AI check is "closer than r", and comparing
+// against r * r gives the same answer without a square root.
+struct Perception
+{
+    float distance_squared;  // from the enemy to the player
+    float offset_x;          // the enemy's x minus the player's; positive means the player is to its left
+    float flow_x;            // the way along the ground to the player (see FlowField), 0 if there's none; only filled in for
+                             // policies that follow it
+};
+
+// For each of count points, the squared distance to (point_x, point_y) and
+// the x offset from it. Plain loops over packed arrays, which the compiler
+// turns into SIMD.
+void perceive_point(float point_x, float point_y, const float* positions_x, const float* positions_y, int count,
+                    float* distances_squared, float* offsets_x);
@@ -0,0 +1,263 @@
+#define GL_SILENCE_DEPRECATION
+#define STB_IMAGE_IMPLEMENTATION
+#define LOG(argument) std::cout << argument << '\n'
+
+#include <cstdlib>
+#include <iostream>
+#include "stb_image.h"
+#include "ResourceCache.h"
+
+#define NUMBER_OF_TEXTURES 1
+#define LEVEL_OF_DETAIL    0
+#define TEXTURE_BORDER     0
+#define BYTES_PER_TEXEL    4  // everything goes up as RGBA8
+
+ResourceCache::~ResourceCache()
+{
+    unload_all();
+}
+
+ResourceHandle ResourceCache::find(const char* path, ResourceType type)
+{
+    std::unordered_map<std::string, int>::const_iterator found = m_lookup.find(path);
+    if (found == m_lookup.end()) return NO_RESOURCE;
+
+    Slot& slot = m_slots[found->second];
+    if (slot.type != type)
+    {
+        LOG(path << " is already loaded as something else");
+        return NO_RESOURCE;
+    }
+
+    slot.ref_count++;
+    m_hit_count++;
+
+    ResourceHandle handle = { (unsigned int)found->second, slot.generation };
+    return handle;
+}
+
+ResourceHandle ResourceCache::insert(const Slot& loaded)
+{
+    int index;
+    if (m_first_free >= 0)
+    {
+        index = m_first_free;
+        m_first_free = m_slots[index].next_free;
+    }
+    else
+    {
+        index = (int)m_slots.size();
+        Slot slot = {};
+        m_slots.push_back(slot);
+    }
+
+    // Generations skip 0 when they wrap, as EntityTable's do
+    Slot& slot = m_slots[index];
+    unsigned int generation = slot.generation + 1 == 0 ? 1 : slot.generation + 1;
+    slot = loaded;
+    slot.ref_count  = 1;
+    slot.generation = generation;
+    slot.next_free  = -1;
+
+    m_lookup[slot.path] = index;
+    m_resident_bytes += slot.bytes;
+    m_load_count++;
+
+    ResourceHandle handle = { (unsigned int)index, slot.generation };
+    return handle;
+}
+
+ResourceCache::Slot* ResourceCache::get_slot(ResourceHandle handle, ResourceType type)
+{
+    if (handle.index >= m_slots.size()) return nullptr;
+
+    Slot& slot = m_slots[handle.index];
+    return slot.generation == handle.generation && slot.ref_count > 0 && slot.type == type ? &slot : nullptr;
+}
+
+const ResourceCache::Slot* ResourceCache::get_slot(ResourceHandle handle, ResourceType type) const
+{
+    return const_cast<ResourceCache*>(this)->get_slot(handle, type);
+}
+
+ResourceHandle ResourceCache::load_texture(const char* path)
+{
+    ResourceHandle cached = find(path, RESOURCE_TEXTURE);
+    if (cached.generation != 0) return cached;
+
+    int width, height, number_of_components;
+    unsigned char* image = stbi_load(path, &width, &height, &number_of_components, STBI_rgb_alpha);
+
+    if (image == NULL)
+    {
+        LOG("Unable to load " << path << ". Make sure the path is correct.");
+        return NO_RESOURCE;
+    }
+
+    ResourceHandle handle = create_texture(path, image, width, height);
+    stbi_image_free(image);
+
+    return handle;
+}
+
+ResourceHandle ResourceCache::create_texture(const char* name, const unsigned char* pixels, int width, int height)
+{
+    ResourceHandle cached = find(name, RESOURCE_TEXTURE);
+    if (cached.generation != 0) return cached;
+
+    GLuint texture_id;
+    glGenTextures(NUMBER_OF_TEXTURES, &texture_id);
+    glBindTexture(GL_TEXTURE_2D, texture_id);
+    glTexImage2D(GL_TEXTURE_2D, LEVEL_OF_DETAIL, GL_RGBA, width, height, TEXTURE_BORDER, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+    Slot loaded = {};
+    loaded.path       = name;
+    loaded.type       = RESOURCE_TEXTURE;
+    loaded.bytes      = (size_t)width * height * BYTES_PER_TEXEL;
+    loaded.texture_id = texture_id;
+    loaded.width      = width;
+    loaded.height     = height;
+    return insert(loaded);
+}
+
+ResourceHandle ResourceCache::load_music(const char* path)
+{
+    ResourceHandle cached = find(path, RESOURCE_MUSIC);
+    if (cached.generation != 0) return cached;
+
+    Mix_Music* music = Mix_LoadMUS(path);
+    if (music == NULL)
+    {
+        LOG("Unable to load " << path << ". Make sure the path is correct.");
+        return NO_RESOURCE;
+    }
+
+    return adopt_music(path, music);
+}
+
+ResourceHandle ResourceCache::adopt_music(const char* path, Mix_Music* music, void* file_data, size_t file_bytes)
+{
+    // If the path got in some other way while this was decoding, this copy
+    // isn't needed
+    ResourceHandle cached = find(path, RESOURCE_MUSIC);
+    if (cached.generation != 0)
+    {
+        Mix_FreeMusic(music);
+        free(file_data);
+        return cached;
+    }
+
+    // Music streams from its source as it plays, so what it holds is its
+    // file if that's in memory, and nothing if it's reading from disk
+    Slot loaded = {};
+    loaded.path       = path;
+    loaded.type       = RESOURCE_MUSIC;
+    loaded.bytes      = file_bytes;
+    loaded.music      = music;
+    loaded.music_data = file_data;
+    return insert(loaded);
+}
+
+ResourceHandle ResourceCache::load_sound(const char* path)
+{
+    ResourceHandle cached = find(path, RESOURCE_SOUND);
+    if (cached.generation != 0) return cached;
+
+    Mix_Chunk* sound = Mix_LoadWAV(path);
+    if (sound == NULL)
+    {
+        LOG("Unable to load " << path << ". Make sure the path is correct.");
+        return NO_RESOURCE;
+    }
+
+    return adopt_sound(path, sound);
+}
+
+ResourceHandle ResourceCache::adopt_sound(const char* path, Mix_Chunk* sound)
+{
+    ResourceHandle cached = find(path, RESOURCE_SOUND);
+    if (cached.generation != 0)
+    {
+        Mix_FreeChunk(sound);
+        return cached;
+    }
+
+    Slot loaded = {};
+    loaded.path  = path;
+    loaded.type  = RESOURCE_SOUND;
+    loaded.bytes = sound->alen;
+    loaded.sound = sound;
+    return insert(loaded);
+}
+
+void ResourceCache::acquire(ResourceHandle handle)
+{
+    if (handle.index >= m_slots.size()) return;
+
+    Slot& slot = m_slots[handle.index];
+    if (slot.generation == handle.generation && slot.ref_count > 0) slot.ref_count++;
+}
+
+void ResourceCache::release(ResourceHandle handle)
+{
+    if (handle.index >= m_slots.size()) return;
+
+    Slot& slot = m_slots[handle.index];
+    if (slot.generation != handle.generation || slot.ref_count == 0) return;
+    if (--slot.ref_count > 0) return;
+
+    switch (slot.type)
+    {
+    case RESOURCE_TEXTURE: glDeleteTextures(NUMBER_OF_TEXTURES, &slot.texture_id); break;
+    case RESOURCE_MUSIC:   Mix_FreeMusic(slot.music); free(slot.music_data);       break;
+    case RESOURCE_SOUND:   Mix_FreeChunk(slot.sound);                              break;
+    }
+
+    // As in EntityTable, the generation moves on now so the old handles go
+    // stale straight away
+    m_lookup.erase(slot.path);
+    m_resident_bytes -= slot.bytes;
+
+    unsigned int generation = slot.generation + 1 == 0 ? 1 : slot.generation + 1;
+    slot = Slot();
+    slot.generation = generation;
+    slot.next_free  = m_first_free;
+    m_first_free    = (int)handle.index;
+}
+
+void ResourceCache::unload_all()
+{
+    for (int i = 0; i < (int)m_slots.size(); i++)
+    {
+        Slot& slot = m_slots[i];
+        if (slot.ref_count == 0) continue;
+
+        slot.ref_count = 1;
+        ResourceHandle handle = { (unsigned int)i, slot.generation };
+        release(handle);
+    }
+}
+
+GLuint ResourceCache::get_texture(ResourceHandle handle) const
+{
+    const Slot* slot = get_slot(handle, RESOURCE_TEXTURE);
+    return slot != nullptr ? slot->texture_id : 0;
+}
+
+Mix_Music* ResourceCache::get_music(ResourceHandle handle) const
+{
+    const Slot* slot = get_slot(handle, RESOURCE_MUSIC);
+    return slot != nullptr ? slot->music : nullptr;
+}
+
+Mix_Chunk* ResourceCache::get_sound(ResourceHandle handle) const
+{
+    const Slot* slot = get_slot(handle, RESOURCE_SOUND);
+    return slot != nullptr ? slot->sound : nullptr;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+#define GL_GLEXT_PROTOTYPES 1
+#include <SDL_opengl.h>
+#include <SDL_mixer.h>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// A reference to a loaded resource. Like an EntityHandle, the generation has
+// to match the slot's, so a handle to something that's been unloaded stops
+// resolving instead of picking up whatever gets loaded into the slot next.
+struct ResourceHandle
+{
+    unsigned int index;
+    unsigned int generation;  // 0 is never handed out, so a zeroed handle is no resource
+};
+
+const ResourceHandle NO_RESOURCE = { 0, 0 };
+
+enum ResourceType { RESOURCE_TEXTURE, RESOURCE_MUSIC, RESOURCE_SOUND };
+
+// Textures, music and sound effects, each loaded once per path however many
+// times it's asked for. Every load of a path that's already resident is a
+// cache hit that only bumps its reference count; release() drops one, and
+// the last one frees it, GL texture and all.
+//
+// The counters are there to prove the point: once the game is running, no
+// frame should add to the load count.
+class ResourceCache
+{
+private:
+    struct Slot
+    {
+        std::string  path;
+        ResourceType type;
+        int          ref_count;
+        unsigned int generation;
+        int          next_free;  // the free list runs through the empty slots
+        size_t       bytes;      // what it holds in memory, on the GPU for textures
+
+        GLuint     texture_id;
+        int        width, height;
+        Mix_Music* music;
+        Mix_Chunk* sound;
+        void*      music_data;  // the file a music plays from, if it's in memory
+    };
+
+    std::vector<Slot>                    m_slots;
+    std::unordered_map<std::string, int> m_lookup;  // path to slot, for the resident ones
+    int m_first_free = -1;
+
+    size_t m_resident_bytes = 0;
+    int    m_load_count     = 0;  // actual decodes, since the start
+    int    m_hit_count      = 0;  // loads answered from the cache instead
+
+    // The path's slot with one more reference if it's resident as this type,
+    // or NO_RESOURCE
+    ResourceHandle find(const char* path, ResourceType type);
+    ResourceHandle insert(const Slot& loaded);
+
+    Slot*       get_slot(ResourceHandle handle, ResourceType type);
+    const Slot* get_slot(ResourceHandle handle, ResourceType type) const;
+
+public:
+    // ————— METHODS ————— //
+    ResourceCache() = default;
+    ~ResourceCache();
+
+    ResourceCache(const ResourceCache&) = delete;
+    ResourceCache& operator=(const ResourceCache&) = delete;
+
+    // Each returns NO_RESOURCE if the file can't be loaded. Textures need the
+    // GL context current, and music and sounds an open audio device.
+    ResourceHandle load_texture(const char* path);
+    ResourceHandle load_music(const char* path);
+    ResourceHandle load_sound(const char* path);
+
+    // The same, for what's already been decoded, e.g. by AssetLoader's
+    // workers. A texture's pixels are RGBA and only read here; its name is
+    // usually the path it came from, but anything unique does, which is how
+    // generated textures go in. Music and sounds become the cache's, and are
+    // freed straight away if the path turns out to be resident already. So
+    // does a music's file data, if it plays from memory; that has to come
+    // from malloc, and is freed after the music.
+    ResourceHandle create_texture(const char* name, const unsigned char* pixels, int width, int height);
+    ResourceHandle adopt_music(const char* path, Mix_Music* music, void* file_data = nullptr, size_t file_bytes = 0);
+    ResourceHandle adopt_sound(const char* path, Mix_Chunk* sound);
+
+    void acquire(ResourceHandle handle);  // one more reference, for a copy of the handle
+    void release(ResourceHandle handle);  // one fewer, unloading on the last; stale handles do nothing
+    void unload_all();                    // everything, whatever its count; handles all go stale
+
+    // ————— GETTERS ————— //
+    // Each is 0 or nullptr for a stale handle, or one of another type
+    GLuint     get_texture(ResourceHandle handle) const;
+    Mix_Music* get_music(ResourceHandle handle)   const;
+    Mix_Chunk* get_sound(ResourceHandle handle)   const;
+
+    size_t const get_resident_bytes() const { return m_resident_bytes;     };
+    int    const get_resident_count() const { return (int)m_lookup.size(); };
+    int    const get_load_count()     const { return m_load_count;         };
+    int    const get_hit_count()      const { return m_hit_count;          };
+};
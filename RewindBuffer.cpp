@@ -0,0 +1,182 @@
+#include <cstring>
+#include "RewindBuffer.h"
+
+// Seven bits at a time, low first; the top bit says another byte follows
+static size_t write_varint(unsigned char* bytes, size_t at, size_t value)
+{
+    while (value >= 0x80)
+    {
+        bytes[at++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    bytes[at++] = (unsigned char)value;
+    return at;
+}
+
+static size_t read_varint(const unsigned char* bytes, size_t& at)
+{
+    size_t value = 0;
+    for (int shift = 0; ; shift += 7)
+    {
+        unsigned char byte = bytes[at++];
+        value |= (size_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return value;
+    }
+}
+
+RewindBuffer::RewindBuffer(size_t capacity_bytes, int max_frames) :
+    m_ring(capacity_bytes),
+    m_records(max_frames > 0 ? max_frames : 1)
+{
+}
+
+void RewindBuffer::reset(size_t snapshot_size)
+{
+    m_snapshot_size = (snapshot_size + 3) & ~(size_t)3;
+    m_has_snapshot  = false;
+
+    // Padding words stay zero, so they never show up in a delta
+    size_t words = m_snapshot_size / 4;
+    m_current.assign(words, 0);
+    m_next.assign(words, 0);
+
+    // Worst case is every other word changed: two one-byte counts per
+    // changed word on top of the word itself, plus the counts' extra bytes
+    m_encoded.resize(words * 6 + 32);
+
+    m_ring_start   = 0;
+    m_ring_used    = 0;
+    m_first_record = 0;
+    m_record_count = 0;
+}
+
+void RewindBuffer::encode_delta()
+{
+    const uint32_t* current = m_current.data();
+    const uint32_t* next    = m_next.data();
+    unsigned char*  bytes   = m_encoded.data();
+
+    size_t words = m_current.size();
+    size_t at    = 0;
+    size_t word  = 0;
+
+    while (word < words)
+    {
+        size_t zero_start = word;
+        while (word < words && current[word] == next[word]) word++;
+
+        // Trailing zero words are implied by the end of the delta
+        if (word == words) break;
+
+        size_t changed_start = word;
+        while (word < words && current[word] != next[word]) word++;
+
+        size_t changed = word - changed_start;
+        at = write_varint(bytes, at, changed_start - zero_start);
+        at = write_varint(bytes, at, changed);
+
+        for (size_t i = 0; i < changed; i++)
+        {
+            uint32_t delta = current[changed_start + i] ^ next[changed_start + i];
+            memcpy(bytes + at, &delta, 4);
+            at += 4;
+        }
+    }
+
+    m_encoded_size = at;
+}
+
+void RewindBuffer::apply_delta(const Record& record)
+{
+    // Unwrap the record out of the ring first, so decoding reads straight
+    size_t capacity = m_ring.size();
+    size_t first    = capacity - record.offset < record.size ? capacity - record.offset : record.size;
+
+    unsigned char* bytes = m_encoded.data();
+    memcpy(bytes, m_ring.data() + record.offset, first);
+    memcpy(bytes + first, m_ring.data(), record.size - first);
+
+    uint32_t* current = m_current.data();
+    size_t at   = 0;
+    size_t word = 0;
+
+    while (at < record.size)
+    {
+        word += read_varint(bytes, at);
+        size_t changed = read_varint(bytes, at);
+
+        for (size_t i = 0; i < changed; i++)
+        {
+            uint32_t delta;
+            memcpy(&delta, bytes + at, 4);
+            current[word++] ^= delta;
+            at += 4;
+        }
+    }
+}
+
+void RewindBuffer::drop_oldest()
+{
+    const Record& oldest = m_records[m_first_record];
+
+    m_ring_start = (m_ring_start + oldest.size) % m_ring.size();
+    m_ring_used -= oldest.size;
+
+    m_first_record = (m_first_record + 1) % (int)m_records.size();
+    m_record_count--;
+}
+
+void RewindBuffer::end_push()
+{
+    // The very first snapshot has nothing to be a delta against
+    if (!m_has_snapshot)
+    {
+        m_current.swap(m_next);
+        m_has_snapshot = true;
+        return;
+    }
+
+    encode_delta();
+    size_t capacity = m_ring.size();
+
+    // STEP 1: Make room, oldest first. A delta bigger than the whole ring
+    // can't be kept at all, and the history starts over from here.
+    if (m_encoded_size > capacity)
+    {
+        while (m_record_count > 0) drop_oldest();
+        m_current.swap(m_next);
+        return;
+    }
+
+    while (m_record_count > 0 && (m_record_count == (int)m_records.size() || m_ring_used + m_encoded_size > capacity)) drop_oldest();
+
+    // STEP 2: Copy it in after the newest record, wrapping around the end
+    size_t offset = (m_ring_start + m_ring_used) % capacity;
+    size_t first  = capacity - offset < m_encoded_size ? capacity - offset : m_encoded_size;
+
+    memcpy(m_ring.data() + offset, m_encoded.data(), first);
+    memcpy(m_ring.data(), m_encoded.data() + first, m_encoded_size - first);
+
+    Record& record = m_records[(m_first_record + m_record_count) % (int)m_records.size()];
+    record.offset = offset;
+    record.size   = m_encoded_size;
+
+    m_ring_used += m_encoded_size;
+    m_record_count++;
+
+    // STEP 3: The new snapshot is now the newest
+    m_current.swap(m_next);
+}
+
+const unsigned char* RewindBuffer::pop()
+{
+    if (m_record_count == 0) return nullptr;
+
+    const Record& newest = m_records[(m_first_record + m_record_count - 1) % (int)m_records.size()];
+    apply_delta(newest);
+
+    m_ring_used -= newest.size;
+    m_record_count--;
+
+    return reinterpret_cast<const unsigned char*>(m_current.data());
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A fixed-memory history of world snapshots, newest last, for scrubbing time
+// backwards.
+//
+// Only the newest snapshot is kept whole. Every older one is stored as the
+// XOR of it and the snapshot after it, and since XOR undoes itself, applying
+// the newest delta to the newest snapshot gives back the one before. Most of
+// the world doesn't change in a tick, so a delta is mostly zero words and is
+// stored as runs: a varint count of zero words, a varint count of changed
+// words, then the changed words.
+//
+// The deltas share one ring of bytes. When a new one doesn't fit, or the
+// frame limit is reached, the oldest are dropped. Everything is allocated in
+// reset(), so pushing and popping never touch the heap.
+class RewindBuffer
+{
+private:
+    struct Record
+    {
+        size_t offset;  // into m_ring
+        size_t size;
+    };
+
+    size_t m_snapshot_size = 0;  // in bytes, a multiple of 4
+    bool   m_has_snapshot  = false;
+
+    std::vector<uint32_t> m_current;  // the newest snapshot
+    std::vector<uint32_t> m_next;     // the one being written by the caller
+    std::vector<unsigned char> m_encoded;  // one delta, on its way in or out of the ring
+    size_t m_encoded_size = 0;
+
+    std::vector<unsigned char> m_ring;
+    size_t m_ring_start = 0;  // where the oldest record begins
+    size_t m_ring_used  = 0;
+
+    std::vector<Record> m_records;  // also a ring, m_first_record the oldest
+    int m_first_record = 0;
+    int m_record_count = 0;
+
+    void encode_delta();
+    void apply_delta(const Record& record);
+    void drop_oldest();
+
+public:
+    // ————— METHODS ————— //
+    // Holds at most max_frames deltas in at most capacity_bytes of encoded data
+    RewindBuffer(size_t capacity_bytes, int max_frames);
+
+    // Forgets everything and sizes the buffers for snapshots of this many bytes
+    void reset(size_t snapshot_size);
+
+    // Write the new snapshot into begin_push()'s memory, then call end_push()
+    unsigned char* begin_push() { return reinterpret_cast<unsigned char*>(m_next.data()); };
+    void           end_push();
+
+    // Steps the newest snapshot back one tick and returns it, or returns
+    // nullptr when there's no older one left
+    const unsigned char* pop();
+
+    // ————— GETTERS ————— //
+    int    const get_frame_count()   const { return m_record_count;   };
+    size_t const get_used_bytes()    const { return m_ring_used;      };
+    size_t const get_capacity()      const { return m_ring.size();    };
+    size_t const get_snapshot_size() const { return m_snapshot_size;  };
+};
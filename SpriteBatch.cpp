@@ -0,0 +1,107 @@
+#define GL_SILENCE_DEPRECATION
+
+#include <algorithm>
+#include "glm/mat4x4.hpp"
+#include "FrameArena.h"
+#include "ShaderProgram.h"
+#include "SpriteBatch.h"
+
+#define FLOATS_PER_VERTEX 4
+#define VERTICES_PER_QUAD 6
+
+void SpriteBatch::initialise()
+{
+    glGenBuffers(1, &m_vertex_buffer);
+    m_buffer_bytes = 0;
+}
+
+void SpriteBatch::shutdown()
+{
+    glDeleteBuffers(1, &m_vertex_buffer);
+    m_vertex_buffer = 0;
+    m_buffer_bytes  = 0;
+}
+
+void SpriteBatch::add(GLuint texture_id, float center_x, float center_y, float half_width, float half_height, const AtlasRect& frame)
+{
+    Quad quad = { texture_id, center_x - half_width, center_y - half_height, center_x + half_width, center_y + half_height, frame };
+
+    m_order.push_back(((unsigned long long)texture_id << 32) | (unsigned long long)m_quads.size());
+    m_quads.push_back(quad);
+}
+
+void SpriteBatch::flush(ShaderProgram* program, FrameArena* arena)
+{
+    m_quad_count = (int)m_quads.size();
+    m_draw_calls = 0;
+    if (m_quad_count == 0) return;
+
+    // STEP 1: Group the quads by texture
+    std::sort(m_order.begin(), m_order.end());
+
+    // STEP 2: Bake every quad's corners and UVs in that order; the top of
+    // the frame is at v, same as the sheets are laid out
+    size_t vertex_floats = (size_t)m_quad_count * VERTICES_PER_QUAD * FLOATS_PER_VERTEX;
+    float* vertices = arena->allocate_array<float>(vertex_floats);
+    float* vertex   = vertices;
+
+    for (int i = 0; i < m_quad_count; i++)
+    {
+        const Quad& quad = m_quads[(size_t)(m_order[i] & 0xffffffffull)];
+        float u0 = quad.frame.u, u1 = quad.frame.u + quad.frame.width;
+        float v0 = quad.frame.v, v1 = quad.frame.v + quad.frame.height;
+
+        const float corners[VERTICES_PER_QUAD * FLOATS_PER_VERTEX] =
+        {
+            quad.left,  quad.bottom, u0, v1,
+            quad.right, quad.bottom, u1, v1,
+            quad.right, quad.top,    u1, v0,
+            quad.left,  quad.bottom, u0, v1,
+            quad.right, quad.top,    u1, v0,
+            quad.left,  quad.top,    u0, v0,
+        };
+
+        std::copy(corners, corners + VERTICES_PER_QUAD * FLOATS_PER_VERTEX, vertex);
+        vertex += VERTICES_PER_QUAD * FLOATS_PER_VERTEX;
+    }
+
+    // STEP 3: Stream them into the buffer. Respecifying it every frame lets
+    // the driver hand over fresh memory instead of waiting on last frame's draws.
+    size_t bytes = vertex_floats * sizeof(float);
+    if (bytes > m_buffer_bytes) m_buffer_bytes = bytes;
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertex_buffer);
+    glBufferData(GL_ARRAY_BUFFER, m_buffer_bytes, NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, vertices);
+
+    // Everything is in world space already
+    program->set_model_matrix(glm::mat4(1.0f));
+
+    GLsizei stride = FLOATS_PER_VERTEX * sizeof(float);
+    glVertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, stride, (const void*)0);
+    glEnableVertexAttribArray(program->get_position_attribute());
+    glVertexAttribPointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, stride, (const void*)(2 * sizeof(float)));
+    glEnableVertexAttribArray(program->get_tex_coordinate_attribute());
+
+    // STEP 4: One draw per texture
+    int first = 0;
+    while (first < m_quad_count)
+    {
+        GLuint texture_id = (GLuint)(m_order[first] >> 32);
+        int last = first + 1;
+        while (last < m_quad_count && (GLuint)(m_order[last] >> 32) == texture_id) last++;
+
+        glBindTexture(GL_TEXTURE_2D, texture_id);
+        glDrawArrays(GL_TRIANGLES, first * VERTICES_PER_QUAD, (last - first) * VERTICES_PER_QUAD);
+        m_draw_calls++;
+
+        first = last;
+    }
+
+    glDisableVertexAttribArray(program->get_position_attribute());
+    glDisableVertexAttribArray(program->get_tex_coordinate_attribute());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    m_quads.clear();
+    m_order.clear();
+}
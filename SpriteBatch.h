@@ -0,0 +1,62 @@
+#pragma once
+
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+#define GL_GLEXT_PROTOTYPES 1
+#include <SDL_opengl.h>
+#include <cstddef>
+#include <vector>
+#include "AnimationClips.h"
+
+class FrameArena;
+class ShaderProgram;
+
+// Every quad of a frame, drawn in as few calls as there are textures. add()
+// only writes the quad down, with its corners already in world space and its
+// frame's UVs, so nothing needs a model matrix of its own. flush() sorts the
+// quads by texture, bakes them all into one streaming vertex buffer and then
+// draws each texture's run of it in one glDrawArrays.
+//
+// Within a texture, quads keep the order they were added in, so one added
+// later still draws over one added earlier.
+//
+// The quads keep their biggest size, and the vertices are baked into the
+// frame's arena, so after the busiest frame so far a flush never touches the
+// heap.
+class SpriteBatch
+{
+private:
+    struct Quad
+    {
+        GLuint    texture_id;
+        float     left, bottom, right, top;
+        AtlasRect frame;
+    };
+
+    std::vector<Quad>               m_quads;
+    std::vector<unsigned long long> m_order;     // texture id over the quad's index, so sorting sorts by texture and keeps the order within
+
+    GLuint m_vertex_buffer = 0;
+    size_t m_buffer_bytes  = 0;  // what the GL buffer has room for
+
+    int m_draw_calls = 0;  // in the last flush
+    int m_quad_count = 0;
+
+public:
+    // ————— METHODS ————— //
+    // Both need the GL context current
+    void initialise();
+    void shutdown();
+
+    void add(GLuint texture_id, float center_x, float center_y, float half_width, float half_height, const AtlasRect& frame);
+
+    // Draws everything added since the last flush with the program's view
+    // and projection, and starts over. The vertices are only needed until
+    // they're uploaded, so they come out of the arena.
+    void flush(ShaderProgram* program, FrameArena* arena);
+
+    // ————— GETTERS ————— //
+    int const get_draw_calls() const { return m_draw_calls; };
+    int const get_quad_count() const { return m_quad_count; };
+};
@@ -0,0 +1,192 @@
+#define GL_SILENCE_DEPRECATION
+#define LOG(argument) std::cout << argument << '\n'
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include "FrameArena.h"
+#include "ShaderProgram.h"
+#include "SpriteBatch.h"
+#include "SpriteInstances.h"
+
+#define CORNERS_PER_QUAD 6
+#define FRAME_TABLE_UNIT 1  // the sprites' own texture is on unit 0
+
+static const float UNIT_QUAD[CORNERS_PER_QUAD * 2] =
+{
+    -0.5f, -0.5f,  0.5f, -0.5f,  0.5f, 0.5f,
+    -0.5f, -0.5f,  0.5f,  0.5f, -0.5f, 0.5f
+};
+
+// Instancing and attribute divisors are both core from 3.3
+static bool supports_instancing()
+{
+    const char* version = (const char*)glGetString(GL_VERSION);
+    int major = 0, minor = 0;
+    if (version == NULL || sscanf(version, "%d.%d", &major, &minor) != 2) return false;
+
+    return major > 3 || (major == 3 && minor >= 3);
+}
+
+void SpriteInstances::initialise(ShaderProgram* program, const AtlasRect* frames, int frame_count)
+{
+    m_program     = program;
+    m_frames      = frames;
+    m_frame_count = frame_count;
+    m_instancing  = supports_instancing();
+    if (!m_instancing) return;
+
+    GLuint program_id = program->get_program_id();
+    m_corner_attribute   = glGetAttribLocation(program_id, "corner");
+    m_position_attribute = glGetAttribLocation(program_id, "instancePosition");
+    m_size_attribute     = glGetAttribLocation(program_id, "instanceSize");
+    m_frame_attribute    = glGetAttribLocation(program_id, "instanceFrame");
+
+    // A driver is free to optimise an attribute away, and -1 isn't a slot
+    // that can be enabled or given a divisor, so without all four the
+    // sprites go through the batch just as they would on an older GL
+    if (m_corner_attribute < 0 || m_position_attribute < 0 || m_size_attribute < 0 || m_frame_attribute < 0)
+    {
+        LOG("The instanced program is missing an attribute; drawing sprites through the batch instead");
+        m_instancing = false;
+        return;
+    }
+
+    // The frame table only changes if the atlas does, so it's uploaded once.
+    // A font's worth of frames is more than a uniform array can be counted
+    // on to hold, so it's a one-texel-high float texture instead.
+    glGenTextures(1, &m_frame_table);
+    glActiveTexture(GL_TEXTURE0 + FRAME_TABLE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, m_frame_table);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, frame_count, 1, 0, GL_RGBA, GL_FLOAT, frames);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glActiveTexture(GL_TEXTURE0);
+
+    glUseProgram(program_id);
+    glUniform1i(glGetUniformLocation(program_id, "frameTable"), FRAME_TABLE_UNIT);
+    glUniform1f(glGetUniformLocation(program_id, "frameCount"), (float)frame_count);
+
+    glGenBuffers(1, &m_corner_buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, m_corner_buffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(UNIT_QUAD), UNIT_QUAD, GL_STATIC_DRAW);
+
+    glGenBuffers(1, &m_instance_buffer);
+    m_buffer_bytes = 0;
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void SpriteInstances::shutdown()
+{
+    if (m_instancing)
+    {
+        glDeleteBuffers(1, &m_corner_buffer);
+        glDeleteBuffers(1, &m_instance_buffer);
+        glDeleteTextures(1, &m_frame_table);
+    }
+
+    m_corner_buffer = m_instance_buffer = 0;
+    m_frame_table   = 0;
+    m_buffer_bytes  = 0;
+}
+
+void SpriteInstances::add(GLuint texture_id, float center_x, float center_y, float width, float height, int frame)
+{
+    Instance instance = { center_x, center_y, width, height, (float)frame };
+
+    m_order.push_back(((unsigned long long)texture_id << 32) | (unsigned long long)m_instances.size());
+    m_instances.push_back(instance);
+    m_textures.push_back(texture_id);
+}
+
+void SpriteInstances::flush(SpriteBatch* fallback, FrameArena* arena)
+{
+    m_instance_count = (int)m_instances.size();
+    m_draw_calls     = 0;
+
+    if (!m_instancing)
+    {
+        // The same sprites, with the frames looked up here instead
+        const AtlasRect* frames = m_frames;
+        for (int i = 0; i < m_instance_count; i++)
+        {
+            const Instance& instance = m_instances[i];
+            fallback->add(m_textures[i], instance.x, instance.y, 0.5f * instance.width, 0.5f * instance.height, frames[(int)instance.frame]);
+        }
+    }
+    else if (m_instance_count > 0)
+    {
+        // STEP 1: Group the instances by texture
+        std::sort(m_order.begin(), m_order.end());
+
+        Instance* sorted = arena->allocate_array<Instance>(m_instance_count);
+        for (int i = 0; i < m_instance_count; i++) sorted[i] = m_instances[(size_t)(m_order[i] & 0xffffffffull)];
+
+        // STEP 2: Stream them into the instance buffer, respecified so the
+        // driver doesn't wait on last frame's draws
+        size_t bytes = (size_t)m_instance_count * sizeof(Instance);
+        if (bytes > m_buffer_bytes) m_buffer_bytes = bytes;
+
+        glBindBuffer(GL_ARRAY_BUFFER, m_instance_buffer);
+        glBufferData(GL_ARRAY_BUFFER, m_buffer_bytes, NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, sorted);
+
+        glUseProgram(m_program->get_program_id());
+
+        glActiveTexture(GL_TEXTURE0 + FRAME_TABLE_UNIT);
+        glBindTexture(GL_TEXTURE_2D, m_frame_table);
+        glActiveTexture(GL_TEXTURE0);
+
+        glBindBuffer(GL_ARRAY_BUFFER, m_corner_buffer);
+        glVertexAttribPointer(m_corner_attribute, 2, GL_FLOAT, false, 0, (const void*)0);
+        glEnableVertexAttribArray(m_corner_attribute);
+
+        glBindBuffer(GL_ARRAY_BUFFER, m_instance_buffer);
+        glEnableVertexAttribArray(m_position_attribute);
+        glEnableVertexAttribArray(m_size_attribute);
+        glEnableVertexAttribArray(m_frame_attribute);
+        glVertexAttribDivisor(m_position_attribute, 1);
+        glVertexAttribDivisor(m_size_attribute, 1);
+        glVertexAttribDivisor(m_frame_attribute, 1);
+
+        // STEP 3: One instanced draw per texture. There's no base instance
+        // before GL 4.2, so each run gets the attributes pointed at its start.
+        GLsizei stride = sizeof(Instance);
+        int first = 0;
+        while (first < m_instance_count)
+        {
+            GLuint texture_id = (GLuint)(m_order[first] >> 32);
+            int last = first + 1;
+            while (last < m_instance_count && (GLuint)(m_order[last] >> 32) == texture_id) last++;
+
+            size_t offset = (size_t)first * sizeof(Instance);
+            glVertexAttribPointer(m_position_attribute, 2, GL_FLOAT, false, stride, (const void*)(offset + offsetof(Instance, x)));
+            glVertexAttribPointer(m_size_attribute,     2, GL_FLOAT, false, stride, (const void*)(offset + offsetof(Instance, width)));
+            glVertexAttribPointer(m_frame_attribute,    1, GL_FLOAT, false, stride, (const void*)(offset + offsetof(Instance, frame)));
+
+            glBindTexture(GL_TEXTURE_2D, texture_id);
+            glDrawArraysInstanced(GL_TRIANGLES, 0, CORNERS_PER_QUAD, last - first);
+            m_draw_calls++;
+
+            first = last;
+        }
+
+        // Divisors belong to the attribute slots, not the program, so they're
+        // put back for the batch's draws
+        glVertexAttribDivisor(m_position_attribute, 0);
+        glVertexAttribDivisor(m_size_attribute, 0);
+        glVertexAttribDivisor(m_frame_attribute, 0);
+        glDisableVertexAttribArray(m_corner_attribute);
+        glDisableVertexAttribArray(m_position_attribute);
+        glDisableVertexAttribArray(m_size_attribute);
+        glDisableVertexAttribArray(m_frame_attribute);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    m_instances.clear();
+    m_textures.clear();
+    m_order.clear();
+}
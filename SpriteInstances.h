@@ -0,0 +1,79 @@
+#pragma once
+
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+#define GL_GLEXT_PROTOTYPES 1
+#include <SDL_opengl.h>
+#include <cstddef>
+#include <vector>
+#include "AnimationClips.h"
+
+class FrameArena;
+class ShaderProgram;
+class SpriteBatch;
+
+// Sprites drawn as instances of one unit quad. Each is only a position, a
+// size and an index into the atlas' frame table (see TextureAtlas.h), five
+// floats in all; the instanced vertex shader builds the corners and UVs from
+// those and its copy of the table, which it keeps in a texture. Sprites are
+// sorted by texture like SpriteBatch does, so however many there are, each
+// texture is one glDrawArraysInstanced.
+//
+// Instancing needs GL 3.3, and every attribute of the instanced program to
+// have survived linking. Without either, flush() hands the sprites to a
+// SpriteBatch instead, with their frames looked up on the CPU.
+class SpriteInstances
+{
+private:
+    struct Instance
+    {
+        float x, y;
+        float width, height;
+        float frame;  // a float so the whole instance is one attribute type
+    };
+
+    std::vector<Instance>           m_instances;
+    std::vector<GLuint>             m_textures;  // per instance
+    std::vector<unsigned long long> m_order;     // texture id over the instance's index, as in SpriteBatch
+
+    ShaderProgram*   m_program     = nullptr;
+    bool             m_instancing  = false;
+    const AtlasRect* m_frames      = nullptr;
+    int              m_frame_count = 0;
+    GLuint           m_frame_table = 0;  // one RGBA float texel per frame: u, v, width, height
+
+    GLuint m_corner_buffer   = 0;  // the unit quad, six corners, never changes
+    GLuint m_instance_buffer = 0;
+    size_t m_buffer_bytes    = 0;
+
+    GLint m_corner_attribute   = -1;
+    GLint m_position_attribute = -1;
+    GLint m_size_attribute     = -1;
+    GLint m_frame_attribute    = -1;
+
+    int m_draw_calls     = 0;  // in the last flush
+    int m_instance_count = 0;
+
+public:
+    // ————— METHODS ————— //
+    // Both need the GL context current. The program is the instanced variant,
+    // loaded from shaders/vertex_instanced.glsl, with its view and projection
+    // already set. The frames are the atlas', which has to outlive this; they
+    // go up to the GPU once, here.
+    void initialise(ShaderProgram* program, const AtlasRect* frames, int frame_count);
+    void shutdown();
+
+    void add(GLuint texture_id, float center_x, float center_y, float width, float height, int frame);
+
+    // Draws everything added since the last flush and starts over. Without
+    // instancing the sprites go into the fallback batch, to be drawn with
+    // its next flush. The instances are sorted into the arena on their way
+    // to the GPU.
+    void flush(SpriteBatch* fallback, FrameArena* arena);
+
+    // ————— GETTERS ————— //
+    bool const is_instancing()      const { return m_instancing;     };
+    int  const get_draw_calls()     const { return m_draw_calls;     };
+    int  const get_instance_count() const { return m_instance_count; };
+};
@@ -0,0 +1,131 @@
+#include <cmath>
+#include "StaticMap.h"
+
+void StaticMap::clear()
+{
+    m_boxes.clear();
+    m_cell_starts.clear();
+    m_cell_boxes.clear();
+    m_columns = 0;
+    m_rows = 0;
+    m_overflow_count.store(0);
+}
+
+void StaticMap::add_box(float center_x, float center_y, float half_width, float half_height)
+{
+    StaticBox box = { center_x, center_y, half_width, half_height };
+    m_boxes.push_back(box);
+}
+
+void StaticMap::bake(float cell_size)
+{
+    m_cell_size = cell_size;
+    m_inverse_cell_size = 1.0f / cell_size;
+    m_cell_starts.clear();
+    m_cell_boxes.clear();
+
+    if (m_boxes.empty())
+    {
+        m_columns = 0;
+        m_rows = 0;
+        return;
+    }
+
+    // STEP 1: The grid covers the bounds of every box, plus a cell of slack
+    float min_x = m_boxes[0].center_x, max_x = min_x;
+    float min_y = m_boxes[0].center_y, max_y = min_y;
+
+    for (const StaticBox& box : m_boxes)
+    {
+        min_x = std::fmin(min_x, box.center_x - box.half_width);
+        max_x = std::fmax(max_x, box.center_x + box.half_width);
+        min_y = std::fmin(min_y, box.center_y - box.half_height);
+        max_y = std::fmax(max_y, box.center_y + box.half_height);
+    }
+
+    m_origin_x = std::floor(min_x * m_inverse_cell_size) * m_cell_size - m_cell_size;
+    m_origin_y = std::floor(min_y * m_inverse_cell_size) * m_cell_size - m_cell_size;
+    m_columns  = column_of(max_x) + 2;
+    m_rows     = row_of(max_y) + 2;
+
+    // STEP 2: Counting sort of (box, cell) pairs into per-cell lists; boxes are
+    // visited in id order, so every cell's list comes out sorted
+    m_cell_starts.assign(m_columns * m_rows + 1, 0);
+
+    for (const StaticBox& box : m_boxes)
+    {
+        for (int row = row_of(box.center_y - box.half_height); row <= row_of(box.center_y + box.half_height); row++)
+            for (int column = column_of(box.center_x - box.half_width); column <= column_of(box.center_x + box.half_width); column++)
+                m_cell_starts[row * m_columns + column + 1]++;
+    }
+
+    for (int cell = 0; cell < m_columns * m_rows; cell++) m_cell_starts[cell + 1] += m_cell_starts[cell];
+
+    m_cell_boxes.resize(m_cell_starts.back());
+    std::vector<int> cursor(m_cell_starts.begin(), m_cell_starts.end() - 1);
+
+    for (int i = 0; i < (int)m_boxes.size(); i++)
+    {
+        const StaticBox& box = m_boxes[i];
+        for (int row = row_of(box.center_y - box.half_height); row <= row_of(box.center_y + box.half_height); row++)
+            for (int column = column_of(box.center_x - box.half_width); column <= column_of(box.center_x + box.half_width); column++)
+                m_cell_boxes[cursor[row * m_columns + column]++] = i;
+    }
+}
+
+int StaticMap::find_overlapping(float center_x, float center_y, float half_width, float half_height, int* boxes, int capacity) const
+{
+    if (m_columns == 0) return 0;
+
+    float min_x = center_x - half_width, max_x = center_x + half_width;
+    float min_y = center_y - half_height, max_y = center_y + half_height;
+
+    // Nothing lives outside the baked bounds
+    if (max_x < m_origin_x || max_y < m_origin_y) return 0;
+
+    int first_column = min_x < m_origin_x ? 0 : column_of(min_x);
+    int first_row    = min_y < m_origin_y ? 0 : row_of(min_y);
+    int last_column  = column_of(max_x) < m_columns - 1 ? column_of(max_x) : m_columns - 1;
+    int last_row     = row_of(max_y)    < m_rows - 1    ? row_of(max_y)    : m_rows - 1;
+
+    int count = 0;
+
+    for (int row = first_row; row <= last_row; row++)
+    {
+        for (int column = first_column; column <= last_column; column++)
+        {
+            int cell = row * m_columns + column;
+
+            for (int i = m_cell_starts[cell]; i < m_cell_starts[cell + 1]; i++)
+            {
+                int id = m_cell_boxes[i];
+                const StaticBox& box = m_boxes[id];
+
+                // Same test as Entity::check_collision, so both agree on what touches
+                float x_distance = std::fabs(center_x - box.center_x) - (half_width + box.half_width);
+                float y_distance = std::fabs(center_y - box.center_y) - (half_height + box.half_height);
+                if (x_distance >= 0.0f || y_distance >= 0.0f) continue;
+
+                // Insert in id order, skipping boxes already found through another cell
+                int slot = count;
+                while (slot > 0 && boxes[slot - 1] > id) slot--;
+                if (slot > 0 && boxes[slot - 1] == id) continue;
+
+                // Full, so the highest id goes: either this one, or the last
+                // one kept, which this one then pushes out
+                if (count == capacity)
+                {
+                    m_overflow_count.fetch_add(1, std::memory_order_relaxed);
+                    if (slot == count) continue;
+                    count--;
+                }
+
+                for (int j = count; j > slot; j--) boxes[j] = boxes[j - 1];
+                boxes[slot] = id;
+                count++;
+            }
+        }
+    }
+
+    return count;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+struct StaticBox
+{
+    float center_x, center_y;
+    float half_width, half_height;
+};
+
+// Collision geometry that never moves, baked once at level load. The level's
+// bounds are cut into a dense grid of cells and each cell keeps the list of
+// boxes that touch it, so finding what a body overlaps is a direct index into
+// at most a handful of cells, no matter how many platforms the level has.
+class StaticMap
+{
+private:
+    std::vector<StaticBox> m_boxes;
+
+    float m_cell_size = 1.0f;
+    float m_inverse_cell_size = 1.0f;
+    float m_origin_x = 0.0f, m_origin_y = 0.0f;
+    int   m_columns = 0, m_rows = 0;
+
+    std::vector<int> m_cell_starts;  // cell c holds m_cell_boxes[starts[c], starts[c + 1])
+    std::vector<int> m_cell_boxes;
+
+    // Boxes dropped from queries that found more than they had room for.
+    // Atomic, since the world's parallel passes all query the one map.
+    mutable std::atomic<int> m_overflow_count{ 0 };
+
+    int const column_of(float x) const { return (int)((x - m_origin_x) * m_inverse_cell_size); };
+    int const row_of(float y)    const { return (int)((y - m_origin_y) * m_inverse_cell_size); };
+
+public:
+    static const int MAX_OVERLAPS = 32;
+
+    // ————— METHODS ————— //
+    void clear();
+    void add_box(float center_x, float center_y, float half_width, float half_height);
+    void bake(float cell_size);
+
+    // Writes the ids of every box the given box strictly overlaps into boxes,
+    // lowest id first, and returns how many there were. Past capacity it's
+    // the capacity lowest ids that are kept, and the rest are counted as
+    // overflow. Meant for a body's own box, which only ever overlaps a few.
+    int find_overlapping(float center_x, float center_y, float half_width, float half_height, int* boxes, int capacity) const;
+
+    // Calls visit(id, box) once for every box the given box strictly
+    // overlaps, however many there are, in no particular order. This is the
+    // one for swept boxes, which can cover any number of platforms.
+    template <typename Visit>
+    void for_each_overlapping(float center_x, float center_y, float half_width, float half_height, const Visit& visit) const
+    {
+        if (m_columns == 0) return;
+
+        float min_x = center_x - half_width, max_x = center_x + half_width;
+        float min_y = center_y - half_height, max_y = center_y + half_height;
+        if (max_x < m_origin_x || max_y < m_origin_y) return;
+
+        int first_column = min_x < m_origin_x ? 0 : column_of(min_x);
+        int first_row    = min_y < m_origin_y ? 0 : row_of(min_y);
+        int last_column  = column_of(max_x) < m_columns - 1 ? column_of(max_x) : m_columns - 1;
+        int last_row     = row_of(max_y)    < m_rows - 1    ? row_of(max_y)    : m_rows - 1;
+
+        for (int row = first_row; row <= last_row; row++)
+        {
+            for (int column = first_column; column <= last_column; column++)
+            {
+                int cell = row * m_columns + column;
+
+                for (int i = m_cell_starts[cell]; i < m_cell_starts[cell + 1]; i++)
+                {
+                    int id = m_cell_boxes[i];
+                    const StaticBox& box = m_boxes[id];
+
+                    // A box in several of these cells is only visited from the
+                    // first of them, so nothing needs to remember what's been seen
+                    int box_row    = row_of(box.center_y - box.half_height);
+                    int box_column = column_of(box.center_x - box.half_width);
+                    if (row != (box_row > first_row ? box_row : first_row) || column != (box_column > first_column ? box_column : first_column)) continue;
+
+                    float x_distance = std::fabs(center_x - box.center_x) - (half_width + box.half_width);
+                    float y_distance = std::fabs(center_y - box.center_y) - (half_height + box.half_height);
+                    if (x_distance >= 0.0f || y_distance >= 0.0f) continue;
+
+                    visit(id, box);
+                }
+            }
+        }
+    };
+
+    // ————— GETTERS ————— //
+    const StaticBox& get_box(int box)    const { return m_boxes[box];         };
+    int        const get_box_count()     const { return (int)m_boxes.size();  };
+    int        const get_columns()       const { return m_columns;            };
+    int        const get_rows()          const { return m_rows;               };
+    float      const get_cell_size()     const { return m_cell_size;          };
+    float      const get_origin_x()      const { return m_origin_x;           };
+    float      const get_origin_y()      const { return m_origin_y;           };
+    int        const get_overflow_count() const { return m_overflow_count.load(); };
+};
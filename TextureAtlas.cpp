@@ -0,0 +1,110 @@
+#include <cstring>
+#include <fstream>
+#include "TextureAtlas.h"
+
+#define ATLAS_MANIFEST_MAGIC "P1AT"
+#define ATLAS_MANIFEST_VERSION 1
+
+template <typename T>
+static void write_field(std::ofstream& file, const T& value) { file.write(reinterpret_cast<const char*>(&value), sizeof(T)); }
+
+template <typename T>
+static bool read_field(std::ifstream& file, T& value) { return (bool)file.read(reinterpret_cast<char*>(&value), sizeof(T)); }
+
+void TextureAtlas::reset(int width, int height)
+{
+    m_width  = width;
+    m_height = height;
+    m_regions.clear();
+    m_frames.clear();
+}
+
+void TextureAtlas::add_region(const char* name, int x, int y, int width, int height, int columns, int rows)
+{
+    AtlasRegion region;
+    memset(&region, 0, sizeof(region));
+    strncpy(region.name, name, ATLAS_NAME_LENGTH - 1);
+
+    region.x = x;
+    region.y = y;
+    region.width  = width;
+    region.height = height;
+    region.columns = columns;
+    region.rows    = rows;
+    region.first_frame = (int)m_frames.size();
+    m_regions.push_back(region);
+
+    // The cells, in texture coordinates of the whole atlas
+    float cell_width  = (float)width  / (float)columns;
+    float cell_height = (float)height / (float)rows;
+
+    for (int cell = 0; cell < columns * rows; cell++)
+    {
+        AtlasRect frame = {
+            ((float)x + (float)(cell % columns) * cell_width)  / (float)m_width,
+            ((float)y + (float)(cell / columns) * cell_height) / (float)m_height,
+            cell_width  / (float)m_width,
+            cell_height / (float)m_height
+        };
+        m_frames.push_back(frame);
+    }
+}
+
+bool TextureAtlas::save(const char* path) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    file.write(ATLAS_MANIFEST_MAGIC, 4);
+    write_field(file, (int)ATLAS_MANIFEST_VERSION);
+    write_field(file, m_width);
+    write_field(file, m_height);
+
+    write_field(file, (int)m_regions.size());
+    file.write(reinterpret_cast<const char*>(m_regions.data()), m_regions.size() * sizeof(AtlasRegion));
+
+    write_field(file, (int)m_frames.size());
+    file.write(reinterpret_cast<const char*>(m_frames.data()), m_frames.size() * sizeof(AtlasRect));
+
+    return (bool)file;
+}
+
+bool TextureAtlas::load(const char* path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    char magic[4];
+    int version, region_count, frame_count;
+
+    if (!file.read(magic, 4) || memcmp(magic, ATLAS_MANIFEST_MAGIC, 4) != 0) return false;
+    if (!read_field(file, version) || version != ATLAS_MANIFEST_VERSION)     return false;
+    if (!read_field(file, m_width) || !read_field(file, m_height))           return false;
+
+    if (!read_field(file, region_count) || region_count < 0) return false;
+    m_regions.resize(region_count);
+    if (!file.read(reinterpret_cast<char*>(m_regions.data()), region_count * sizeof(AtlasRegion))) return false;
+
+    if (!read_field(file, frame_count) || frame_count < 0) return false;
+    m_frames.resize(frame_count);
+    if (!file.read(reinterpret_cast<char*>(m_frames.data()), frame_count * sizeof(AtlasRect))) return false;
+
+    // Names are written padded, but a bad file shouldn't run off the end of
+    // one, or have regions whose cells run off the end of the frames
+    for (AtlasRegion& region : m_regions)
+    {
+        region.name[ATLAS_NAME_LENGTH - 1] = '\0';
+        if (region.first_frame < 0 || region.first_frame + region.columns * region.rows > frame_count) return false;
+    }
+
+    return true;
+}
+
+int TextureAtlas::find_region(const char* name) const
+{
+    for (int i = 0; i < (int)m_regions.size(); i++)
+    {
+        if (strcmp(m_regions[i].name, name) == 0) return i;
+    }
+    return -1;
+}
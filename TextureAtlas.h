@@ -0,0 +1,54 @@
+#pragma once
+
+#define ATLAS_NAME_LENGTH 32
+
+#include <vector>
+#include "AnimationClips.h"
+
+// One source sheet's place in the atlas, in pixels, and the grid its frames
+// are cut on. Its cells are in the atlas' frame table left to right and top
+// to bottom from first_frame, so a clip's cells (see AnimationClips.h) are
+// frames from there too.
+struct AtlasRegion
+{
+    char name[ATLAS_NAME_LENGTH];
+    int  x, y;
+    int  width, height;
+    int  columns, rows;
+    int  first_frame;
+};
+
+// Every sprite sheet and the font, packed into one texture ahead of time by
+// the AtlasPacker tool (atlas_packer.cpp), and its manifest: a binary file of
+// the named regions and every region's frames as texture coordinates. The
+// game loads the manifest and the packed image once, looks its sheets up by
+// name, and from then on names a frame by its index in the table.
+class TextureAtlas
+{
+private:
+    int m_width  = 0;
+    int m_height = 0;
+
+    std::vector<AtlasRegion> m_regions;
+    std::vector<AtlasRect>   m_frames;
+
+public:
+    // ————— METHODS ————— //
+    // What the packer builds a manifest up with: the atlas' size, then each
+    // region where it was put, which adds its frames
+    void reset(int width, int height);
+    void add_region(const char* name, int x, int y, int width, int height, int columns, int rows);
+
+    bool save(const char* path) const;
+    bool load(const char* path);  // false if it can't be read or isn't a manifest
+
+    int find_region(const char* name) const;  // -1 if there's no such region
+
+    // ————— GETTERS ————— //
+    int                const get_width()            const { return m_width;                  };
+    int                const get_height()           const { return m_height;                 };
+    int                const get_region_count()     const { return (int)m_regions.size();    };
+    const AtlasRegion&       get_region(int region) const { return m_regions[region];        };
+    const AtlasRect*         get_frames()           const { return m_frames.data();          };
+    int                const get_frame_count()      const { return (int)m_frames.size();     };
+};
@@ -0,0 +1,883 @@
+#include <cmath>
+#include <cstring>
+#include <random>
+#include "AIPolicies.h"
+#include "InputLog.h"
+#include "Overlap.h"
+#include "World.h"
+
+World::World(float time_step, int thread_count) :
+    m_jobs(thread_count),
+    m_rewind(REWIND_BUFFER_BYTES, REWIND_FRAMES)
+{
+    m_time_step = time_step;
+}
+
+World::~World()
+{
+    shutdown();
+}
+
+void World::initialise(const SceneConfig& config)
+{
+    shutdown();
+
+    m_state = GameState();
+    m_scene = config;
+    if (m_scene.spare_enemies < 0) m_scene.spare_enemies = 0;
+    m_input = 0;
+    m_previous_ticks   = 0.0;
+    m_time_accumulator = 0.0;
+
+    if (config.type == STRESS_SCENE) build_stress_scene(m_scene);
+    else                             build_level_scene();
+
+    bake_static_map();
+    m_flow_field.bake(m_static_map, STATIC_MAP_CELL_SIZE);
+
+    if (m_rewind_enabled) start_rewind_history();
+}
+
+void World::shutdown()
+{
+    delete[] m_state.platforms;
+    delete   m_state.player;
+    delete[] m_state.enemies;
+
+    m_state.platforms = nullptr;
+    m_state.player    = nullptr;
+    m_state.enemies   = nullptr;
+
+    m_bodies.clear();
+    m_entities.clear();
+    m_enemy_pool.reset(0, 0);
+    m_dynamic_body_count = 0;
+
+    m_static_map.clear();
+    m_flow_field.clear();
+    m_overlap_hits.clear();
+    m_player_distances_squared.clear();
+    m_player_offsets_x.clear();
+    m_awake_enemies.clear();
+    m_awake_runs.clear();
+    m_awake_body_count = 0;
+    for (std::vector<int>& bucket : m_awake_by_type) bucket.clear();
+    m_ai_types.clear();
+    m_ai_waits.clear();
+    m_ai_due.clear();
+}
+
+void World::allocate_entities(int platform_count, int enemy_count)
+{
+    m_state.platform_count = platform_count;
+    m_state.enemy_count    = enemy_count;
+
+    m_state.player    = new Entity();
+    m_state.enemies   = new Entity[enemy_count];
+    m_state.platforms = new Entity[platform_count];
+
+    // Dynamic bodies first so the integrate passes can stop before the platforms
+    m_bodies.reserve(1 + enemy_count + platform_count);
+    m_entities.reserve(1 + enemy_count + platform_count);
+
+    m_state.player->attach_body(&m_bodies, m_bodies.create());
+    for (int i = 0; i < enemy_count; i++) m_state.enemies[i].attach_body(&m_bodies, m_bodies.create());
+
+    m_dynamic_body_count = m_bodies.get_count();
+
+    for (int i = 0; i < platform_count; i++) m_state.platforms[i].attach_body(&m_bodies, m_bodies.create());
+
+    // Handles in the same order, so they come out the same on every run;
+    // enemies get theirs as they spawn
+    m_state.player->attach_handle(m_entities.create(m_state.player));
+    for (int i = 0; i < platform_count; i++) m_state.platforms[i].attach_handle(m_entities.create(&m_state.platforms[i]));
+
+    // Only the player's contacts have any gameplay in them; the enemies'
+    // collision passes just keep their sides, and stay free of shared writes
+    m_state.player->attach_contacts(&m_contacts);
+
+    for (int i = 0; i < enemy_count; i++)
+    {
+        m_state.enemies[i].set_entity_type(ENEMY);
+        m_state.enemies[i].set_ai_type(WALKER);
+        m_state.enemies[i].deactivate();
+    }
+    m_enemy_pool.reset(enemy_count, 0);
+
+    // Size the per-tick scratch up front so the first ticks don't grow it.
+    // Any slot can be spawned as any type, so every bucket can take them all.
+    m_overlap_hits.resize(enemy_count);
+    m_player_distances_squared.resize(enemy_count);
+    m_player_offsets_x.resize(enemy_count);
+    m_candidates.reserve(64);
+    m_contacts.reserve(CONTACT_BUFFER_CAPACITY);
+    m_awake_enemies.reserve(enemy_count);
+    m_awake_runs.reserve(enemy_count + 1);
+
+    m_ai_types.assign(enemy_count, (unsigned char)WALKER);
+    for (std::vector<int>& bucket : m_awake_by_type) bucket.reserve(enemy_count);
+    m_ai_due.reserve(enemy_count);
+    m_ai_waits.assign(enemy_count, 0);
+    m_ai_cursor = 0;
+}
+
+EntityHandle World::spawn_enemy(AIType ai_type, glm::vec3 position)
+{
+    int slot = m_enemy_pool.spawn();
+    if (slot < 0) return NO_ENTITY;
+
+    Entity& enemy = m_state.enemies[slot];
+
+    // STEP 1: A fresh body where it's asked for, not moving and awake
+    enemy.set_position(position);
+    enemy.set_velocity(glm::vec3(0.0f));
+    enemy.set_acceleration(glm::vec3(0.0f, ai_type == JUMPER ? -1.5f : -9.81f, 0.0f));
+    enemy.set_width(1.0f);
+    enemy.set_height(1.0f);
+    enemy.activate();
+    enemy.wake();
+
+    // STEP 2: Everything else from scratch, the same way a snapshot restores it
+    EntityState state;
+    memset(&state, 0, sizeof(state));
+    state.animation_clip = NO_CLIP;
+    state.ai_type        = ai_type;
+    state.ai_state       = ai_type == PATROLLER ? PATROL : IDLE;
+    state.speed          = 0.5f;
+    state.jumping_power  = 3.0f;
+    state.pt1            = position.x + 1.0f;
+    state.pt2            = position.x - 1.0f;
+    enemy.load_state(state);
+
+    // STEP 3: Its own handle and its place in the AI's arrays. The waits
+    // are staggered by slot, so far enemies don't all come due together.
+    enemy.attach_handle(m_entities.create(&enemy));
+    m_ai_types[slot] = (unsigned char)ai_type;
+    m_ai_waits[slot] = (unsigned char)(slot % AI_FAR_PERIOD);
+
+    return enemy.get_handle();
+}
+
+void World::despawn_enemy(EntityHandle handle)
+{
+    Entity* enemy = m_entities.get(handle);
+    if (enemy == nullptr || enemy->get_entity_type() != ENEMY) return;
+
+    enemy->deactivate();
+    m_entities.destroy(handle);
+    enemy->attach_handle(NO_ENTITY);
+    m_enemy_pool.despawn((int)(enemy - m_state.enemies));
+}
+
+void World::build_level_scene()
+{
+    allocate_entities(PLATFORM_COUNT, ENEMY_COUNT + m_scene.spare_enemies);
+
+    // ––––– PLATFORMS ––––– //
+    glm::vec3 platform_positions[PLATFORM_COUNT];
+    for (int i = 0; i < PLATFORM_COUNT - 2; i++) platform_positions[i] = glm::vec3(i - 5.0f, -3.0f, 0.0f);
+
+    platform_positions[PLATFORM_COUNT - 1] = glm::vec3(-5.0f, -2.35f, 0.0f);
+    platform_positions[PLATFORM_COUNT - 2] = glm::vec3(5.0f, -2.5f, 0.0f);
+    platform_positions[PLATFORM_COUNT - 3] = glm::vec3(0.0f, -0.0f, 0.0f);
+    platform_positions[PLATFORM_COUNT - 4] = glm::vec3(1.0f, -0.0f, 0.0f);
+    platform_positions[PLATFORM_COUNT - 5] = glm::vec3(2.0f, -2.0f, 0.0f);
+    platform_positions[PLATFORM_COUNT - 6] = glm::vec3(3.0f, -1.0f, 0.0f);
+    platform_positions[PLATFORM_COUNT - 7] = glm::vec3(-2.0f, -1.0f, 0.0f);
+    platform_positions[PLATFORM_COUNT - 8] = glm::vec3(-2.0f, -1.0f, 0.0f);
+
+    for (int i = 0; i < PLATFORM_COUNT; i++)
+    {
+        m_state.platforms[i].set_entity_type(PLATFORM);
+        m_state.platforms[i].set_position(platform_positions[i]);
+        m_state.platforms[i].set_width(0.4f);
+    }
+
+    // ––––– PLAYER (GEORGE) ––––– //
+    m_state.player->set_entity_type(PLAYER);
+    m_state.player->set_position(glm::vec3(2.0f, 2.0f, 0.0f));
+    m_state.player->set_movement(glm::vec3(0.0f));
+    m_state.player->set_speed(1.0f);
+    m_state.player->set_acceleration(glm::vec3(0.0f, -4.905f, 0.0f));
+
+    // Walking
+    m_state.player->m_animation_clip = PLAYER_WALK_RIGHT;  // start George looking right
+    m_state.player->m_animation_index = 0;
+    m_state.player->m_animation_time = 0.0f;
+    m_state.player->set_height(0.9f);
+    m_state.player->set_width(0.9f);
+
+    // Jumping
+    m_state.player->set_jumping_power(4.0f);
+
+    // ––––– ENEMIES ––––– //
+    spawn_enemy(RUNNER, glm::vec3(1.5f, 0.0f, 0.0f));
+    spawn_enemy(JUMPER, glm::vec3(3.0f, 0.0f, 0.0f));
+
+    // The patroller sets off straight away, between the level's own points
+    Entity* patroller = m_entities.get(spawn_enemy(PATROLLER, glm::vec3(-4.8f, 0.0f, 0.0f)));
+    patroller->set_movement(glm::vec3(1.0f));
+    patroller->pt1 = -2.0f;
+    patroller->pt2 = -4.0f;
+}
+
+void World::build_stress_scene(const SceneConfig& config)
+{
+    // Same rules as the level, just more of everything: a floor long enough to
+    // hold every enemy, a scattering of floating platforms above it, and
+    // enemies of every AI type dropped in at random.
+    std::mt19937 rng(config.seed);
+
+    int platform_count = config.platform_count < 1 ? 1 : config.platform_count;
+    int enemy_count    = config.enemy_count < 0 ? 0 : config.enemy_count;
+    int floor_count    = platform_count / 2 + 1;
+    float floor_left   = -floor_count / 2.0f;
+
+    allocate_entities(platform_count, enemy_count + config.spare_enemies);
+
+    for (int i = 0; i < platform_count; i++)
+    {
+        glm::vec3 position;
+        if (i < floor_count)
+        {
+            position = glm::vec3(floor_left + i, -3.0f, 0.0f);
+        }
+        else
+        {
+            float x = floor_left + (float)(rng() % (unsigned int)floor_count);
+            float y = -2.0f + (float)(rng() % 4u);
+            position = glm::vec3(x, y, 0.0f);
+        }
+
+        m_state.platforms[i].set_entity_type(PLATFORM);
+        m_state.platforms[i].set_position(position);
+        m_state.platforms[i].set_width(0.4f);
+    }
+
+    m_state.player->set_entity_type(PLAYER);
+    m_state.player->set_position(glm::vec3(0.0f, 2.0f, 0.0f));
+    m_state.player->set_movement(glm::vec3(0.0f));
+    m_state.player->set_speed(1.0f);
+    m_state.player->set_acceleration(glm::vec3(0.0f, -4.905f, 0.0f));
+    m_state.player->set_height(0.9f);
+    m_state.player->set_width(0.9f);
+    m_state.player->set_jumping_power(4.0f);
+
+    // Enemies of the same type go next to each other, so the AI's per-type
+    // buckets (see think_bucket) walk through memory in order
+    std::vector<AIType> ai_types(enemy_count);
+    std::vector<float>  positions_x(enemy_count);
+
+    for (int i = 0; i < enemy_count; i++)
+    {
+        ai_types[i]    = (AIType)(rng() % (unsigned int)AI_TYPE_COUNT);
+        positions_x[i] = floor_left + (float)(rng() % (unsigned int)(floor_count * 100)) / 100.0f;
+    }
+
+    for (int type = 0; type < AI_TYPE_COUNT; type++)
+    {
+        for (int i = 0; i < enemy_count; i++)
+        {
+            if (ai_types[i] == type) spawn_enemy(ai_types[i], glm::vec3(positions_x[i], 0.0f, 0.0f));
+        }
+    }
+}
+
+int World::update(Clock* clock)
+{
+    double ticks = clock->get_seconds();
+    double delta_time = ticks - m_previous_ticks;
+    m_previous_ticks = ticks;
+
+    m_time_accumulator += delta_time;
+
+    int steps = 0;
+    while (m_time_accumulator >= m_time_step && steps < m_max_steps) {
+        step();
+        m_time_accumulator -= m_time_step;
+        steps++;
+    }
+
+    // After a hitch, trying to catch up on every missed step only makes the
+    // next frame later still. Let the world fall behind the clock instead and
+    // keep just the fraction of a step that interpolation needs.
+    if (m_time_accumulator >= m_time_step) m_time_accumulator = fmod(m_time_accumulator, (double)m_time_step);
+
+    return steps;
+}
+
+void World::bake_static_map()
+{
+    m_static_map.clear();
+
+    // Box ids are platform indices, so static contacts resolve in the same
+    // order the platform array used to be walked in
+    for (int i = 0; i < m_state.platform_count; i++)
+    {
+        int body = m_state.platforms[i].get_body();
+        m_static_map.add_box(m_bodies.position_x[body], m_bodies.position_y[body], m_bodies.half_width[body], m_bodies.half_height[body]);
+    }
+
+    m_static_map.bake(STATIC_MAP_CELL_SIZE);
+}
+
+int World::gather_enemy_candidates(float center_x, float center_y, float half_width, float half_height)
+{
+    // Every enemy whose box overlaps the given box right now; the player's
+    // check_collision_* passes make the final call. The enemies' bodies sit
+    // next to each other in the store, so this is one batched sweep over the
+    // packed arrays, and the hits come back in array order, keeping the
+    // resolution order the same as testing against every enemy.
+    m_candidates.clear();
+    if (m_state.enemy_count == 0) return 0;
+
+    int first = m_state.enemies[0].get_body();
+
+    int hit_count = overlap_boxes(center_x, center_y, half_width, half_height,
+                                  &m_bodies.position_x[first], &m_bodies.position_y[first],
+                                  &m_bodies.half_width[first], &m_bodies.half_height[first],
+                                  &m_bodies.active[first], m_state.enemy_count, m_overlap_hits.data());
+
+    for (int i = 0; i < hit_count; i++) m_candidates.push_back(&m_state.enemies[m_overlap_hits[i]]);
+
+    return hit_count;
+}
+
+void World::apply_input()
+{
+    Entity* player = m_state.player;
+    player->set_movement(glm::vec3(0.0f));
+
+    // Jumps only take off from the ground
+    if ((m_input & INPUT_JUMP) && player->has_contact(CONTACT_BOTTOM)) player->m_is_jumping = true;
+
+    if (!m_state.lose) {
+        if (m_input & INPUT_LEFT)
+        {
+            player->move_left();
+            player->m_animation_clip = PLAYER_WALK_LEFT;
+        }
+        else if (m_input & INPUT_RIGHT)
+        {
+            player->move_right();
+            player->m_animation_clip = PLAYER_WALK_RIGHT;
+        }
+    }
+
+    if (m_recorder != nullptr) m_recorder->record(m_input);
+
+    m_input &= ~INPUT_JUMP;
+}
+
+unsigned long long World::hash_state() const
+{
+    unsigned long long hash = 14695981039346656037ull;
+    const std::vector<float>* fields[] = { &m_bodies.position_x, &m_bodies.position_y,
+                                           &m_bodies.velocity_x, &m_bodies.velocity_y, &m_bodies.active };
+
+    for (const std::vector<float>* field : fields)
+    {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(field->data());
+        for (size_t i = 0; i < field->size() * sizeof(float); i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    }
+
+    int outcome[] = { m_state.win, m_state.lose, m_state.enemy_slain };
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(outcome);
+    for (size_t i = 0; i < sizeof(outcome); i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+void World::wake_enemies_near_player()
+{
+    // Nothing but the player ever touches an enemy or sets off its AI, so a
+    // sleeper far enough from the player has nothing to wake up for
+    if (m_state.enemy_count == 0) return;
+
+    int body  = m_state.player->get_body();
+    int first = m_state.enemies[0].get_body();
+
+    int hit_count = overlap_boxes(m_bodies.position_x[body], m_bodies.position_y[body],
+                                  m_bodies.half_width[body] + WAKE_DISTANCE, m_bodies.half_height[body] + WAKE_DISTANCE,
+                                  &m_bodies.position_x[first], &m_bodies.position_y[first],
+                                  &m_bodies.half_width[first], &m_bodies.half_height[first],
+                                  &m_bodies.active[first], m_state.enemy_count, m_overlap_hits.data());
+
+    for (int i = 0; i < hit_count; i++)
+    {
+        Entity& enemy = m_state.enemies[m_overlap_hits[i]];
+        if (enemy.is_asleep()) enemy.wake();
+    }
+}
+
+void World::gather_awake_enemies()
+{
+    m_awake_enemies.clear();
+    m_awake_runs.clear();
+
+    BodyRun player_run = { m_state.player->get_body(), 1 };
+    m_awake_runs.push_back(player_run);
+    m_awake_body_count = 1;
+
+    if (m_state.enemy_count == 0) return;
+
+    // One pass over the pool's live list and the sleep flags, no entities
+    // touched; dead slots aren't in the list at all
+    int first = m_state.enemies[0].get_body();
+    const int*           live   = m_enemy_pool.get_live();
+    const unsigned char* asleep = &m_bodies.asleep[first];
+    int live_count = m_enemy_pool.get_live_count();
+
+    for (int i = 0; i < live_count; i++)
+    {
+        int enemy = live[i];
+        if (asleep[enemy] == 0) m_awake_enemies.push_back(enemy);
+    }
+
+    // The live list is in no particular order, so the runs come from a walk
+    // over the slots instead. The player's body is just before the enemies',
+    // so with enemy 0 awake the first run carries straight on from it.
+    for (int enemy = 0; enemy < m_state.enemy_count; enemy++)
+    {
+        if (asleep[enemy] != 0 || !m_enemy_pool.is_live(enemy)) continue;
+
+        BodyRun& last = m_awake_runs.back();
+        if (last.first + last.count == first + enemy && last.count < ENEMY_JOB_GRAIN)
+        {
+            last.count++;
+        }
+        else
+        {
+            BodyRun run = { first + enemy, 1 };
+            m_awake_runs.push_back(run);
+        }
+    }
+
+    m_awake_body_count = 1 + (int)m_awake_enemies.size();
+}
+
+void World::integrate_awake(void (BodyStore::*pass)(int first, int count, float delta_time), float time_step)
+{
+    BodyStore& bodies = m_bodies;
+
+    // Everyone awake, e.g. with sleeping off, is every dynamic body from the
+    // player's on: one straight run, split however the jobs like
+    if (m_awake_body_count == m_dynamic_body_count)
+    {
+        int first = m_state.player->get_body();
+        m_jobs.parallel_for(m_awake_body_count, ENEMY_JOB_GRAIN, [&](int begin, int end) {
+            (bodies.*pass)(first + begin, end - begin, time_step);
+        });
+        return;
+    }
+
+    const BodyRun* runs = m_awake_runs.data();
+    m_jobs.parallel_for((int)m_awake_runs.size(), BODY_RUN_JOB_GRAIN, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) (bodies.*pass)(runs[i].first, runs[i].count, time_step);
+    });
+}
+
+void World::perceive_player()
+{
+    // Where the player is from every enemy, in one sweep over the packed
+    // positions. Sleepers are included: a straight run over the arrays is
+    // cheaper than picking the awake ones out.
+    int enemy_count = m_state.enemy_count;
+    if (enemy_count == 0) return;
+
+    BodyStore& bodies = m_bodies;
+    int   first    = m_state.enemies[0].get_body();
+    float player_x = bodies.position_x[m_state.player->get_body()];
+    float player_y = bodies.position_y[m_state.player->get_body()];
+    float* distances_squared = m_player_distances_squared.data();
+    float* offsets_x         = m_player_offsets_x.data();
+
+    m_jobs.parallel_for(enemy_count, PERCEPTION_JOB_GRAIN, [&](int begin, int end) {
+        perceive_point(player_x, player_y, &bodies.position_x[first + begin], &bodies.position_y[first + begin], end - begin,
+                       distances_squared + begin, offsets_x + begin);
+    });
+}
+
+void World::schedule_ai()
+{
+    for (std::vector<int>& bucket : m_awake_by_type) bucket.clear();
+    m_ai_due.clear();
+
+    const unsigned char* ai_types = m_ai_types.data();
+
+    if (!m_ai_lod_enabled)
+    {
+        for (int enemy : m_awake_enemies) m_awake_by_type[ai_types[enemy]].push_back(enemy);
+        m_thinking_count = (int)m_awake_enemies.size();
+        return;
+    }
+
+    // STEP 1: Near enemies think every step. Every AI trigger range is well
+    // inside AI_NEAR_DISTANCE, and the distance is this step's, so an enemy
+    // the player walks up to reacts on exactly the step it would have.
+    const float* distances_squared = m_player_distances_squared.data();
+    m_thinking_count = 0;
+
+    for (int enemy : m_awake_enemies)
+    {
+        unsigned char& wait = m_ai_waits[enemy];
+        if (wait < 255) wait++;
+
+        float distance_squared = distances_squared[enemy];
+        int   period = distance_squared < AI_FAR_DISTANCE * AI_FAR_DISTANCE ? AI_MID_PERIOD : AI_FAR_PERIOD;
+
+        if (distance_squared < AI_NEAR_DISTANCE * AI_NEAR_DISTANCE)
+        {
+            m_awake_by_type[ai_types[enemy]].push_back(enemy);
+            m_thinking_count++;
+            wait = 0;
+        }
+        else if (wait >= period) m_ai_due.push_back(enemy);
+    }
+
+    // STEP 2: Everyone else who's due, up to the budget, starting where the
+    // last step's budget ran out so nobody waits forever. The budget counts
+    // enemies, not microseconds, so the result doesn't depend on the machine
+    // and still replays exactly.
+    int due_count = (int)m_ai_due.size();
+    if (due_count == 0) return;
+
+    int taken = due_count < AI_FAR_BUDGET ? due_count : AI_FAR_BUDGET;
+    int start = (int)(m_ai_cursor % (unsigned int)due_count);
+
+    for (int i = 0; i < taken; i++)
+    {
+        int enemy = m_ai_due[(start + i) % due_count];
+        m_awake_by_type[ai_types[enemy]].push_back(enemy);
+        m_ai_waits[enemy] = 0;
+    }
+
+    m_thinking_count += taken;
+    m_ai_cursor = (unsigned int)(start + taken);
+}
+
+template <size_t... TYPES>
+void World::think_enemies(float time_step, std::index_sequence<TYPES...>)
+{
+    int buckets[] = { 0, (think_bucket<(AIType)TYPES>(time_step), 0)... };
+    (void)buckets;
+}
+
+template <AIType TYPE>
+void World::think_bucket(float time_step)
+{
+    Entity* enemies = m_state.enemies;
+    const int*   bucket            = m_awake_by_type[TYPE].data();
+    const float* distances_squared = m_player_distances_squared.data();
+    const float* offsets_x         = m_player_offsets_x.data();
+    const FlowField& flow_field    = m_flow_field;
+    const BodyStore& bodies        = m_bodies;
+    int first = m_state.enemy_count > 0 ? enemies[0].get_body() : 0;
+
+    m_jobs.parallel_for((int)m_awake_by_type[TYPE].size(), ENEMY_JOB_GRAIN, [&](int begin, int end) {
+        for (int i = begin; i < end; i++)
+        {
+            int enemy = bucket[i];
+            if (i + AI_PREFETCH_DISTANCE < end) prefetch_for_ai(enemies[bucket[i + AI_PREFETCH_DISTANCE]]);
+
+            Perception perception = { distances_squared[enemy], offsets_x[enemy], 0.0f };
+
+            // Known at compile time, so types that don't chase never sample
+            if (AIPolicy<TYPE>::FOLLOWS_FLOW)
+                perception.flow_x = flow_field.sample(bodies.position_x[first + enemy], bodies.position_y[first + enemy]);
+
+            enemies[enemy].begin_update<TYPE>(time_step, perception);
+        }
+    });
+}
+
+void World::step()
+{
+    Entity* player = m_state.player;
+    Entity* enemies = m_state.enemies;
+    float time_step = m_time_step;
+    const StaticMap& static_map = m_static_map;
+    BodyStore& bodies = m_bodies;
+    bool sleeping_enabled = m_sleeping_enabled;
+
+    // ––––– REWIND ––––– //
+    if (m_rewind_enabled && (m_input & INPUT_REWIND))
+    {
+        rewind_step();
+        return;
+    }
+
+    // ––––– INPUT ––––– //
+    m_contacts.clear();
+    apply_input();
+
+    // ––––– SLEEPING, PERCEPTION AND AI SCHEDULING ––––– //
+    wake_enemies_near_player();
+    gather_awake_enemies();
+    perceive_player();
+    schedule_ai();
+
+    // The chasers' way to the player, searched again only if they've moved cell
+    int player_body = player->get_body();
+    m_flow_field.update(bodies.position_x[player_body], bodies.position_y[player_body]);
+
+    const int* awake_enemies = m_awake_enemies.data();
+    int awake_enemy_count = (int)m_awake_enemies.size();
+
+    // Enemy passes run as parallel loops over the awake enemies and the body
+    // passes over the awake bodies; each pass still finishes completely
+    // before the next one starts, so the phase order is exactly the serial one
+    // ––––– AI AND INPUT ––––– //
+    player->begin_update(time_step);
+    think_enemies(time_step, std::make_index_sequence<AI_TYPE_COUNT>());
+
+    // ––––– INTEGRATION AND COLLISION ––––– //
+    // One batched pass per axis over every awake body, each followed by that
+    // axis' collision resolution, same order as Entity::update
+    integrate_awake(&BodyStore::integrate_velocity, time_step);
+
+    // Everyone resolves against the static map first, as the platforms used
+    // to come first in the collidable list. Only the player collides with
+    // enemies, asleep or not, and it tests them right after each axis is
+    // integrated, against every enemy its whole path that step touched, not
+    // just its end box.
+    int body = player->get_body();
+    float swept_center, swept_half;
+
+    integrate_awake(&BodyStore::integrate_position_y, time_step);
+
+    player->check_static_collision_y(static_map);
+    m_bodies.swept_y(body, swept_center, swept_half);
+    int candidate_count = gather_enemy_candidates(m_bodies.position_x[body], swept_center, m_bodies.half_width[body], swept_half);
+    player->check_collision_y(m_candidates.data(), candidate_count);
+
+    m_jobs.parallel_for(awake_enemy_count, ENEMY_JOB_GRAIN, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) enemies[awake_enemies[i]].check_static_collision_y(static_map);
+    });
+
+    integrate_awake(&BodyStore::integrate_position_x, time_step);
+
+    player->check_static_collision_x(static_map);
+    m_bodies.swept_x(body, swept_center, swept_half);
+    candidate_count = gather_enemy_candidates(swept_center, m_bodies.position_y[body], swept_half, m_bodies.half_height[body]);
+    player->check_collision_x(m_candidates.data(), candidate_count);
+
+    // The x collision, end_update and the sleep check touch the same enemy
+    // one after the other, so they share a loop
+    player->end_update();
+    m_jobs.parallel_for(awake_enemy_count, ENEMY_JOB_GRAIN, [&](int begin, int end) {
+        for (int i = begin; i < end; i++)
+        {
+            Entity& enemy = enemies[awake_enemies[i]];
+            enemy.check_static_collision_x(static_map);
+            enemy.end_update();
+            if (sleeping_enabled) enemy.update_sleep();
+        }
+    });
+
+    // ––––– WIN / LOSE ––––– //
+    process_contacts();
+
+    if (m_enemy_pool.get_live_count() == 0 && !m_state.lose) {
+        m_state.win = true;
+    }
+
+    if (m_rewind_enabled)
+    {
+        write_snapshot(m_rewind.begin_push());
+        m_rewind.end_push();
+    }
+
+    if (m_recorder != nullptr) m_recorder->record_hash(hash_state());
+}
+
+// Everything the step's collision passes ran into, in the order they found
+// it. Landing on an enemy from above slays it; running into one from the side
+// or from below loses. A stomped enemy's handle goes stale at once, so a
+// second contact with it the same step counts for nothing.
+void World::process_contacts()
+{
+    EntityHandle player = m_state.player->get_handle();
+    const Contact* contacts = m_contacts.get_contacts();
+    int contact_count = m_contacts.get_contact_count();
+
+    for (int i = 0; i < contact_count; i++)
+    {
+        const Contact& contact = contacts[i];
+        if (contact.a != player || contact.b == NO_ENTITY) continue;
+
+        Entity* other = m_entities.get(contact.b);
+        if (other == nullptr || other->get_entity_type() != ENEMY) continue;
+
+        if (contact.normal_y > 0.0f)
+        {
+            despawn_enemy(contact.b);
+            m_state.enemy_slain += 1;
+        }
+        else
+        {
+            m_state.lose = true;
+        }
+    }
+}
+
+// ––––– REWIND ––––– //
+struct SnapshotHeader
+{
+    int win;
+    int lose;
+    int enemy_slain;
+    int body_count;
+    unsigned int ai_cursor;
+};
+
+size_t World::get_snapshot_size() const
+{
+    size_t body_count = (size_t)m_dynamic_body_count;
+    size_t asleep_bytes = (body_count + 3) & ~(size_t)3;  // keeps the EntityStates 4-byte aligned
+
+    size_t ai_wait_bytes = ((size_t)m_state.enemy_count + 3) & ~(size_t)3;
+
+    // Eleven float fields per body; see write_snapshot
+    return sizeof(SnapshotHeader) + body_count * 11 * sizeof(float) + asleep_bytes + ai_wait_bytes +
+           m_enemy_pool.get_snapshot_size() + (size_t)(m_state.enemy_count + 1) * sizeof(EntityState);
+}
+
+void World::write_snapshot(unsigned char* snapshot)
+{
+    // STEP 1: The outcome
+    SnapshotHeader header = { m_state.win, m_state.lose, m_state.enemy_slain, m_dynamic_body_count, m_ai_cursor };
+    memcpy(snapshot, &header, sizeof(header));
+    snapshot += sizeof(header);
+
+    // STEP 2: The body arrays, one straight copy per field. Acceleration and
+    // extents only change when an enemy spawns, so they're mostly zeros in
+    // the rewind deltas.
+    size_t body_count = (size_t)m_dynamic_body_count;
+    std::vector<float>* fields[] = { &m_bodies.position_x, &m_bodies.position_y, &m_bodies.velocity_x, &m_bodies.velocity_y,
+                                     &m_bodies.previous_x, &m_bodies.previous_y, &m_bodies.active,
+                                     &m_bodies.acceleration_x, &m_bodies.acceleration_y, &m_bodies.half_width, &m_bodies.half_height };
+
+    for (std::vector<float>* field : fields)
+    {
+        memcpy(snapshot, field->data(), body_count * sizeof(float));
+        snapshot += body_count * sizeof(float);
+    }
+
+    memcpy(snapshot, m_bodies.asleep.data(), body_count);
+    snapshot += (body_count + 3) & ~(size_t)3;
+
+    memcpy(snapshot, m_ai_waits.data(), m_ai_waits.size());
+    snapshot += (m_ai_waits.size() + 3) & ~(size_t)3;
+
+    m_enemy_pool.write_snapshot(snapshot);
+    snapshot += m_enemy_pool.get_snapshot_size();
+
+    // STEP 3: The entities, player first. Each only writes its own slot.
+    EntityState* states = reinterpret_cast<EntityState*>(snapshot);
+    Entity* enemies = m_state.enemies;
+    int enemy_count = m_state.enemy_count;
+
+    m_state.player->save_state(states[0]);
+
+    m_jobs.parallel_for(enemy_count, ENEMY_JOB_GRAIN, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) enemies[i].save_state(states[i + 1]);
+    });
+}
+
+void World::read_snapshot(const unsigned char* snapshot)
+{
+    SnapshotHeader header;
+    memcpy(&header, snapshot, sizeof(header));
+    snapshot += sizeof(header);
+
+    m_state.win         = header.win != 0;
+    m_state.lose        = header.lose != 0;
+    m_state.enemy_slain = header.enemy_slain;
+    m_ai_cursor         = header.ai_cursor;
+
+    size_t body_count = (size_t)m_dynamic_body_count;
+    std::vector<float>* fields[] = { &m_bodies.position_x, &m_bodies.position_y, &m_bodies.velocity_x, &m_bodies.velocity_y,
+                                     &m_bodies.previous_x, &m_bodies.previous_y, &m_bodies.active,
+                                     &m_bodies.acceleration_x, &m_bodies.acceleration_y, &m_bodies.half_width, &m_bodies.half_height };
+
+    for (std::vector<float>* field : fields)
+    {
+        memcpy(field->data(), snapshot, body_count * sizeof(float));
+        snapshot += body_count * sizeof(float);
+    }
+
+    memcpy(m_bodies.asleep.data(), snapshot, body_count);
+    snapshot += (body_count + 3) & ~(size_t)3;
+
+    memcpy(m_ai_waits.data(), snapshot, m_ai_waits.size());
+    snapshot += (m_ai_waits.size() + 3) & ~(size_t)3;
+
+    m_enemy_pool.read_snapshot(snapshot);
+    snapshot += m_enemy_pool.get_snapshot_size();
+
+    // Bodies are back, so load_state can place the sprites
+    const EntityState* states = reinterpret_cast<const EntityState*>(snapshot);
+    Entity* enemies = m_state.enemies;
+    unsigned char* ai_types = m_ai_types.data();
+
+    m_state.player->load_state(states[0]);
+
+    m_jobs.parallel_for(m_state.enemy_count, ENEMY_JOB_GRAIN, [&](int begin, int end) {
+        for (int i = begin; i < end; i++)
+        {
+            enemies[i].load_state(states[i + 1]);
+            ai_types[i] = (unsigned char)enemies[i].get_ai_type();
+        }
+    });
+
+    // Handles aren't rewound: generations only move forward, so an enemy
+    // brought back gets a new one, and one taken away has its old one go
+    // stale, same as a spawn and a despawn. In slot order, so it replays.
+    for (int i = 0; i < m_state.enemy_count; i++)
+    {
+        bool has_handle = m_entities.get(enemies[i].get_handle()) != nullptr;
+        if (m_enemy_pool.is_live(i) == has_handle) continue;
+
+        if (has_handle)
+        {
+            m_entities.destroy(enemies[i].get_handle());
+            enemies[i].attach_handle(NO_ENTITY);
+        }
+        else enemies[i].attach_handle(m_entities.create(&enemies[i]));
+    }
+}
+
+void World::start_rewind_history()
+{
+    m_rewind.reset(get_snapshot_size());
+    write_snapshot(m_rewind.begin_push());
+    m_rewind.end_push();
+}
+
+void World::set_rewind_enabled(bool enabled)
+{
+    m_rewind_enabled = enabled;
+    if (enabled && m_state.player != nullptr) start_rewind_history();
+}
+
+void World::rewind_step()
+{
+    // Logged like a normal step, so a session that scrubbed back replays
+    if (m_recorder != nullptr) m_recorder->record(m_input);
+    m_input &= ~INPUT_JUMP;
+
+    // Once the history runs out the world just holds still
+    const unsigned char* snapshot = m_rewind.pop();
+    if (snapshot != nullptr) read_snapshot(snapshot);
+
+    if (m_recorder != nullptr) m_recorder->record_hash(hash_state());
+}
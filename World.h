@@ -0,0 +1,258 @@
+#pragma once
+
+#define PLATFORM_COUNT 18
+#define ENEMY_COUNT 3
+#define CONTACT_BUFFER_CAPACITY 256  // contacts one step is expected to need; more just grows the buffer once
+#define STATIC_MAP_CELL_SIZE 1.0f
+#define ENEMY_JOB_GRAIN 256  // enemies per job; smaller loops just run on the calling thread
+#define BODY_RUN_JOB_GRAIN 4  // awake body runs per job; each is up to ENEMY_JOB_GRAIN bodies already
+#define PERCEPTION_JOB_GRAIN 8192  // the perception sweep does so little per enemy it wants bigger jobs
+#define MAX_STEPS_PER_UPDATE 5  // past this, update() drops the time it's behind instead of catching up
+#define WAKE_DISTANCE 4.0f   // sleeping enemies this close to the player wake up; more than any AI trigger range
+#define AI_NEAR_DISTANCE 12.5f  // enemies this close think every tick: the whole 10 x 7.5 screen, and every AI trigger range
+#define AI_FAR_DISTANCE 25.0f   // between the two they think every AI_MID_PERIOD ticks, past this every AI_FAR_PERIOD
+#define AI_MID_PERIOD 2
+#define AI_FAR_PERIOD 8
+#define AI_FAR_BUDGET 2048      // most enemies past AI_NEAR_DISTANCE that think in one tick; the rest wait their turn
+#define REWIND_FRAMES 600           // ten seconds of history at 60 Hz
+#define REWIND_BUFFER_BYTES 524288  // for all of it, delta-encoded
+
+#include <utility>
+#include "glm/mat4x4.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include "BodyStore.h"
+#include "Clock.h"
+#include "Entity.h"
+#include "EntityPool.h"
+#include "FlowField.h"
+#include "JobSystem.h"
+#include "RewindBuffer.h"
+#include "StaticMap.h"
+
+class InputLog;
+
+// ––––– STRUCTS AND ENUMS ––––– //
+enum SceneType { LEVEL_SCENE, STRESS_SCENE };
+
+// One tick of player input as bits, so it can be logged and replayed exactly.
+// A tick with INPUT_REWIND held steps the world one tick back instead.
+enum InputButton { INPUT_LEFT = 1, INPUT_RIGHT = 2, INPUT_JUMP = 4, INPUT_REWIND = 8 };
+
+struct SceneConfig
+{
+    SceneType    type           = LEVEL_SCENE;
+    int          platform_count = PLATFORM_COUNT;  // only used by STRESS_SCENE
+    int          enemy_count    = ENEMY_COUNT;     // only used by STRESS_SCENE
+    int          spare_enemies  = 0;               // pooled enemy slots past the scene's own, for spawn_enemy
+    unsigned int seed           = 0;
+};
+
+struct GameState
+{
+    Entity* player    = nullptr;
+    Entity* platforms = nullptr;
+    Entity* enemies   = nullptr;
+
+    int platform_count = 0;
+    int enemy_count    = 0;  // enemy slots, live or not; the world's enemy pool says which are live
+
+    bool win         = false;
+    bool lose        = false;
+    int  enemy_slain = 0;
+};
+
+// Everything the simulation needs and nothing the window needs: no SDL, no GL,
+// no audio. The game and the headless driver both own one of these.
+class World
+{
+private:
+    GameState   m_state;
+    SceneConfig m_scene;
+    BodyStore   m_bodies;
+    EntityTable m_entities;  // every entity's handle, for links between them
+
+    // ––––– INPUT ––––– //
+    // Applied at the start of every step, so it's part of the fixed-step
+    // simulation rather than the frame, and a log of it replays exactly
+    unsigned char m_input    = 0;
+    InputLog*     m_recorder = nullptr;
+
+    int m_dynamic_body_count = 0;  // the player and enemies, which come first in m_bodies
+
+    // Every enemy phase only writes to that enemy's own state, so the enemy
+    // passes are split across threads and still come out bit-identical
+    JobSystem m_jobs;
+
+    // ––––– SPAWNING ––––– //
+    // The enemy array is allocated once, at its full size, and enemies are
+    // spawned into its free slots; the pool's live list is what every
+    // per-enemy loop walks, so dead slots cost nothing there
+    EntityPool m_enemy_pool;
+
+    // ––––– SLEEPING ––––– //
+    // Enemies resting long enough fall asleep (see Entity::update_sleep) and
+    // drop out of every per-enemy pass; the lists below hold only the awake
+    // ones, rebuilt at the start of each step
+    bool m_sleeping_enabled = true;
+    std::vector<int> m_awake_enemies;  // enemy indices
+
+    // Their bodies and the player's, as runs of consecutive indices, so the
+    // integrate passes stream through them like they would the whole store.
+    // Each run is at most ENEMY_JOB_GRAIN long, so a parallel loop over the
+    // runs stays balanced.
+    struct BodyRun
+    {
+        int first, count;
+    };
+
+    std::vector<BodyRun> m_awake_runs;
+    int m_awake_body_count = 0;
+
+    // ––––– AI SCHEDULING ––––– //
+    // The awake enemies whose AI runs this step, split by AIType so it runs
+    // one type at a time through that type's policy (see AIPolicies.h). The
+    // rest skip begin_update altogether and carry on as they last decided.
+    std::vector<int>           m_awake_by_type[AI_TYPE_COUNT];
+    std::vector<unsigned char> m_ai_types;  // every enemy's AIType, packed, so bucketing doesn't touch entities
+    int                        m_thinking_count = 0;
+
+    // Enemies away from the player think less often (see schedule_ai). Each
+    // counts the steps since it last thought, and the ones due that don't fit
+    // in the step's budget are taken from m_ai_cursor onwards next time.
+    bool m_ai_lod_enabled = true;
+    std::vector<unsigned char> m_ai_waits;
+    std::vector<int>           m_ai_due;
+    unsigned int               m_ai_cursor = 0;
+
+    // ––––– PERCEPTION ––––– //
+    // The player as every enemy sees it this step, by enemy index; the AI
+    // reads these instead of the player's position
+    std::vector<float> m_player_distances_squared;
+    std::vector<float> m_player_offsets_x;
+
+    // ––––– NAVIGATION ––––– //
+    // Built from m_static_map at load and pointed at the player each step;
+    // it's worked out from the player's position alone, so a rewound or
+    // replayed step sees the same field
+    FlowField m_flow_field;
+
+    // ––––– COLLISION ––––– //
+    // Platforms never move, so they're baked into m_static_map at load and
+    // their entities are only kept around to be drawn
+    StaticMap m_static_map;
+    std::vector<int>     m_overlap_hits;  // one slot per enemy, for overlap_boxes
+    std::vector<Entity*> m_candidates;
+
+    // The player's contacts this step, which the win/lose check goes
+    // through in one batch once every collision pass is done
+    ContactBuffer m_contacts;
+
+    // ––––– REWIND ––––– //
+    // A snapshot of every step, so holding INPUT_REWIND can walk back through
+    // them. Rewinding ticks are logged like any other, so they replay too.
+    RewindBuffer m_rewind;
+    bool         m_rewind_enabled = false;
+
+    float  m_time_step;
+    int    m_max_steps        = MAX_STEPS_PER_UPDATE;
+    double m_previous_ticks   = 0.0;
+    double m_time_accumulator = 0.0;
+
+    void allocate_entities(int platform_count, int enemy_count);  // every enemy slot starts free
+    void build_level_scene();
+    void build_stress_scene(const SceneConfig& config);
+
+    void bake_static_map();
+    int  gather_enemy_candidates(float center_x, float center_y, float half_width, float half_height);
+    void apply_input();
+    void wake_enemies_near_player();
+    void gather_awake_enemies();
+    void integrate_awake(void (BodyStore::*pass)(int first, int count, float delta_time), float time_step);
+    void perceive_player();
+    void schedule_ai();
+    void process_contacts();
+
+    // begin_update for every awake enemy, one bucket per AIType
+    template <size_t... TYPES>
+    void think_enemies(float time_step, std::index_sequence<TYPES...>);
+    template <AIType TYPE>
+    void think_bucket(float time_step);
+
+    // A snapshot is the dynamic bodies' fields, the AI scheduler's counters,
+    // the enemy pool, one EntityState per player and enemy slot and the
+    // outcome, packed back to back. The EntityTable isn't in it; see
+    // read_snapshot.
+    size_t get_snapshot_size() const;
+    void   write_snapshot(unsigned char* snapshot);
+    void   read_snapshot(const unsigned char* snapshot);
+    void   start_rewind_history();
+    void   rewind_step();
+
+public:
+    // ————— METHODS ————— //
+    World(float time_step, int thread_count = 0);  // 0 threads means one per core
+    ~World();
+
+    void initialise(const SceneConfig& config);
+    void shutdown();
+
+    // Takes as many fixed steps as the clock says are due, up to the max steps
+    // per update, and returns how many it took
+    int  update(Clock* clock);
+    void step();
+
+    // Buttons held for the coming steps. A jump stays pending until a step
+    // takes it, so a frame that runs no step doesn't lose the key press.
+    void set_input(unsigned char buttons) { m_input = buttons | (m_input & INPUT_JUMP); };
+
+    // Brings an enemy to life in a free slot, with the same defaults as the
+    // stress scene's, and returns its handle, or NO_ENTITY if the pool is
+    // full. Despawning takes it back out; its handle goes stale at once.
+    EntityHandle spawn_enemy(AIType ai_type, glm::vec3 position);
+    void         despawn_enemy(EntityHandle enemy);
+
+    // Every step logs its input and resulting state hash into the recorder
+    void set_recorder(InputLog* recorder) { m_recorder = recorder; };
+
+    // FNV-1a over every body's position, velocity and active flag and the
+    // win/lose state. Sleeping doesn't count: it never changes the outcome.
+    unsigned long long hash_state() const;
+
+    void set_time_step(float time_step) { m_time_step = time_step; };
+    void set_max_steps(int max_steps)   { m_max_steps = max_steps; };
+
+    // Sleeping never changes the outcome, only the cost; turning it off is
+    // there to prove that
+    void set_sleeping_enabled(bool enabled) { m_sleeping_enabled = enabled; };
+
+    // With AI level of detail off every awake enemy thinks every step, as
+    // before; unlike sleeping, that does change what far enemies do
+    void set_ai_lod_enabled(bool enabled) { m_ai_lod_enabled = enabled; };
+
+    // Starts recording history from the current state; off by default, as it
+    // costs a snapshot every step
+    void set_rewind_enabled(bool enabled);
+
+    // ————— GETTERS ————— //
+    GameState&       get_state()           { return m_state;       };
+    const GameState& get_state()     const { return m_state;       };
+    const SceneConfig& get_scene()   const { return m_scene;       };
+    float      const get_time_step() const { return m_time_step;   };
+
+    // How far the clock is between the last step and the next, from 0 to 1;
+    // renderers blend each body's previous and current position by this
+    float      const get_interpolation() const { return (float)(m_time_accumulator / m_time_step); };
+
+    const BodyStore& get_bodies()    const { return m_bodies;      };
+    const EntityTable& get_entities() const { return m_entities;   };
+    const EntityPool& get_enemy_pool() const { return m_enemy_pool; };
+    const StaticMap& get_static_map() const { return m_static_map; };
+    const FlowField& get_flow_field() const { return m_flow_field; };
+    const ContactBuffer& get_contacts() const { return m_contacts; };  // the last step's
+    int        const get_thread_count() const { return m_jobs.get_thread_count(); };
+    int        const get_awake_enemy_count() const { return (int)m_awake_enemies.size(); };
+    int        const get_thinking_enemy_count() const { return m_thinking_count; };
+    int        const get_rewind_frame_count() const { return m_rewind.get_frame_count(); };
+    size_t     const get_rewind_bytes()       const { return m_rewind.get_used_bytes();  };
+    size_t     const get_snapshot_bytes()     const { return m_rewind.get_snapshot_size(); };
+};
@@ -0,0 +1,238 @@
+/**
+* Offline texture atlas packer.
+*
+* Packs every sheet listed in a spec file into one image, with padding around
+* each, and writes that image out with a binary manifest of where each sheet
+* went and every frame of its grid (see TextureAtlas.h). P1 runs it before
+* every build, so the game only ever loads the one texture.
+*
+*   AtlasPacker assets/atlas.txt assets/atlas.tga assets/atlas.bin
+*
+* The spec has one sheet per line: a name, an image and the columns and rows
+* of its grid; '#' starts a comment. The image comes out as an uncompressed
+* 32-bit TGA, which stb_image reads back like any PNG.
+**/
+
+#define STB_IMAGE_IMPLEMENTATION
+#define LOG(argument) std::cout << argument << '\n'
+#define ATLAS_PADDING 2          // pixels between sheets, filled with their edges so nothing bleeds across
+#define ATLAS_MIN_SIZE 256
+#define ATLAS_MAX_SIZE 4096
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "stb_image.h"
+#include "TextureAtlas.h"
+
+struct SourceSheet
+{
+    std::string    name, path;
+    int            columns, rows;
+    int            width, height;
+    unsigned char* pixels;  // RGBA
+    int            x, y;    // where it's been put, inside its padding
+};
+
+static bool read_spec(const char* path, std::vector<SourceSheet>& sheets)
+{
+    std::ifstream file(path);
+    if (!file) return false;
+
+    std::string line;
+    int line_number = 0;
+
+    while (std::getline(file, line))
+    {
+        line_number++;
+        line = line.substr(0, line.find('#'));
+
+        std::istringstream fields(line);
+        SourceSheet sheet = {};
+        if (!(fields >> sheet.name)) continue;  // blank or only a comment
+
+        if (!(fields >> sheet.path >> sheet.columns >> sheet.rows) || sheet.columns < 1 || sheet.rows < 1)
+        {
+            LOG(path << ":" << line_number << ": expected a name, an image, columns and rows");
+            return false;
+        }
+        if (sheet.name.size() >= ATLAS_NAME_LENGTH)
+        {
+            LOG(path << ":" << line_number << ": names are at most " << ATLAS_NAME_LENGTH - 1 << " characters");
+            return false;
+        }
+
+        sheets.push_back(sheet);
+    }
+
+    return true;
+}
+
+// Shelves, tallest sheets first: each row is as tall as its first sheet and
+// takes sheets left to right until the next doesn't fit. Returns the height
+// used at this width, or -1 if a sheet is wider than the atlas.
+static int pack_shelves(std::vector<SourceSheet>& sheets, const std::vector<int>& order, int atlas_width)
+{
+    int x = 0, y = 0, shelf_height = 0;
+
+    for (int index : order)
+    {
+        SourceSheet& sheet = sheets[index];
+        int padded_width  = sheet.width  + 2 * ATLAS_PADDING;
+        int padded_height = sheet.height + 2 * ATLAS_PADDING;
+        if (padded_width > atlas_width) return -1;
+
+        if (x + padded_width > atlas_width)
+        {
+            y += shelf_height;
+            x = 0;
+            shelf_height = 0;
+        }
+
+        sheet.x = x + ATLAS_PADDING;
+        sheet.y = y + ATLAS_PADDING;
+        x += padded_width;
+        shelf_height = std::max(shelf_height, padded_height);
+    }
+
+    return y + shelf_height;
+}
+
+// The sheet, and then its edge pixels smeared out into its padding
+static void blit_sheet(const SourceSheet& sheet, unsigned char* atlas, int atlas_width)
+{
+    for (int row = -ATLAS_PADDING; row < sheet.height + ATLAS_PADDING; row++)
+    {
+        int source_row = std::min(std::max(row, 0), sheet.height - 1);
+
+        for (int column = -ATLAS_PADDING; column < sheet.width + ATLAS_PADDING; column++)
+        {
+            int source_column = std::min(std::max(column, 0), sheet.width - 1);
+
+            const unsigned char* source = sheet.pixels + 4 * (source_row * sheet.width + source_column);
+            unsigned char* destination  = atlas + 4 * ((sheet.y + row) * atlas_width + sheet.x + column);
+            memcpy(destination, source, 4);
+        }
+    }
+}
+
+// Uncompressed true-colour TGA, top row first, BGRA
+static bool write_tga(const char* path, const unsigned char* pixels, int width, int height)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    unsigned char header[18] = {};
+    header[2]  = 2;  // uncompressed true-colour
+    header[12] = (unsigned char)(width & 0xff);
+    header[13] = (unsigned char)(width >> 8);
+    header[14] = (unsigned char)(height & 0xff);
+    header[15] = (unsigned char)(height >> 8);
+    header[16] = 32;
+    header[17] = 0x28;  // 8 bits of alpha, origin at the top left
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    std::vector<unsigned char> row(4 * width);
+    for (int y = 0; y < height; y++)
+    {
+        const unsigned char* source = pixels + 4 * y * width;
+        for (int x = 0; x < width; x++)
+        {
+            row[4 * x + 0] = source[4 * x + 2];
+            row[4 * x + 1] = source[4 * x + 1];
+            row[4 * x + 2] = source[4 * x + 0];
+            row[4 * x + 3] = source[4 * x + 3];
+        }
+        file.write(reinterpret_cast<const char*>(row.data()), row.size());
+    }
+
+    return (bool)file;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 4)
+    {
+        LOG("Usage: AtlasPacker SPEC IMAGE.tga MANIFEST");
+        return 1;
+    }
+
+    // STEP 1: Every sheet in the spec, decoded
+    std::vector<SourceSheet> sheets;
+    if (!read_spec(argv[1], sheets)) return 1;
+
+    for (SourceSheet& sheet : sheets)
+    {
+        int components;
+        sheet.pixels = stbi_load(sheet.path.c_str(), &sheet.width, &sheet.height, &components, STBI_rgb_alpha);
+        if (sheet.pixels == NULL)
+        {
+            LOG("Unable to load " << sheet.path);
+            return 1;
+        }
+    }
+
+    // STEP 2: The smallest power-of-two square, or failing that the smallest
+    // power-of-two rectangle twice as wide as tall, that everything fits in
+    std::vector<int> order(sheets.size());
+    for (int i = 0; i < (int)order.size(); i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return sheets[a].height > sheets[b].height; });
+
+    int atlas_width = 0, atlas_height = 0;
+    for (int size = ATLAS_MIN_SIZE; size <= ATLAS_MAX_SIZE && atlas_width == 0; size *= 2)
+    {
+        int height = pack_shelves(sheets, order, size);
+        if (height < 0) continue;
+
+        if      (height <= size / 2) { atlas_width = size; atlas_height = size / 2; }
+        else if (height <= size)     { atlas_width = size; atlas_height = size;     }
+    }
+
+    if (atlas_width == 0)
+    {
+        LOG("The sheets don't fit in a " << ATLAS_MAX_SIZE << " x " << ATLAS_MAX_SIZE << " atlas");
+        return 1;
+    }
+    pack_shelves(sheets, order, atlas_width);
+
+    // STEP 3: The image, transparent wherever there's no sheet
+    std::vector<unsigned char> atlas(4 * (size_t)atlas_width * atlas_height, 0);
+    for (const SourceSheet& sheet : sheets) blit_sheet(sheet, atlas.data(), atlas_width);
+
+    if (!write_tga(argv[2], atlas.data(), atlas_width, atlas_height))
+    {
+        LOG("Unable to write " << argv[2]);
+        return 1;
+    }
+
+    // STEP 4: The manifest, with the regions in the spec's order so their
+    // frames are too
+    TextureAtlas manifest;
+    manifest.reset(atlas_width, atlas_height);
+    for (const SourceSheet& sheet : sheets)
+    {
+        manifest.add_region(sheet.name.c_str(), sheet.x, sheet.y, sheet.width, sheet.height, sheet.columns, sheet.rows);
+    }
+
+    if (!manifest.save(argv[3]))
+    {
+        LOG("Unable to write " << argv[3]);
+        return 1;
+    }
+
+    int used_pixels = 0;
+    for (const SourceSheet& sheet : sheets)
+    {
+        used_pixels += sheet.width * sheet.height;
+        stbi_image_free(sheet.pixels);
+    }
+
+    LOG("Packed " << sheets.size() << " sheets into " << atlas_width << " x " << atlas_height << " ("
+        << 100 * (long long)used_pixels / ((long long)atlas_width * atlas_height) << "% used), "
+        << manifest.get_frame_count() << " frames");
+    return 0;
+}
@@ -0,0 +1,608 @@
+/**
+* Headless driver for the simulation core.
+*
+* Steps the world a fixed number of ticks with no window, no GL context and no
+* audio, then reports what each tick cost. Build it with the Headless project,
+* which compiles the simulation sources with HEADLESS and nothing else.
+*
+*   Headless --ticks 10000
+*   Headless --scene stress --platforms 2000 --enemies 500 --seed 7
+*   Headless --hz 30
+*   Headless --scene stress --enemies 20000 --threads 4
+*   Headless --scene stress --enemies 20000 --sleep off
+*   Headless --scene stress --enemies 50000 --lod off
+*   Headless --replay session.log
+*   Headless --rewind 600
+*   Headless --scene stress --enemies 20000 --churn 100
+*   Headless --bench overlap
+*   Headless --bench ai
+*   Headless --check tunnelling
+**/
+
+#define LOG(argument) std::cout << argument << '\n'
+#define FIXED_TIMESTEP 0.0166666f
+#define WARM_UP_TICKS 60
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <random>
+#include <utility>
+#include <vector>
+#include "AIPolicies.h"
+#include "InputLog.h"
+#include "Overlap.h"
+#include "World.h"
+
+// ––––– ALLOCATION COUNTING ––––– //
+// Every heap allocation in the process goes through these, which is how the
+// driver shows that a steady-state tick never touches the heap
+static size_t g_heap_allocations = 0;
+
+void* operator new(size_t size)
+{
+    g_heap_allocations++;
+    void* memory = malloc(size > 0 ? size : 1);
+    if (memory == NULL) throw std::bad_alloc();
+    return memory;
+}
+
+void operator delete(void* memory) noexcept         { free(memory); }
+void operator delete(void* memory, size_t) noexcept { free(memory); }
+
+struct DriverConfig
+{
+    int         ticks     = 3600;
+    float       time_step = FIXED_TIMESTEP;
+    int         threads   = 0;  // 0 = one per core
+    bool        sleeping  = true;
+    bool        ai_lod    = true;
+    const char* replay_path = NULL;  // play back a log from P1 --record instead of an idle player
+    int         rewind_ticks = 0;    // after the run, step this many ticks back and check the state matches
+    int         churn        = 0;    // despawn this many enemies before every tick and spawn as many new ones
+    SceneConfig scene;
+    bool        bench_overlap    = false;  // run the overlap micro-benchmark instead of a scene
+    bool        bench_ai         = false;  // run the AI pass benchmark instead of a scene
+    bool        check_tunnelling = false;  // run the tunnelling checks instead of a scene
+};
+
+bool parse_arguments(int argc, char* argv[], DriverConfig& config)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char* argument = argv[i];
+        const char* value    = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (value == NULL)
+        {
+            LOG("Missing value for " << argument);
+            return false;
+        }
+
+        if      (strcmp(argument, "--ticks") == 0)     config.ticks = atoi(value);
+        else if (strcmp(argument, "--platforms") == 0) config.scene.platform_count = atoi(value);
+        else if (strcmp(argument, "--enemies") == 0)   config.scene.enemy_count = atoi(value);
+        else if (strcmp(argument, "--seed") == 0)      config.scene.seed = (unsigned int)strtoul(value, NULL, 10);
+        else if (strcmp(argument, "--scene") == 0)     config.scene.type = strcmp(value, "stress") == 0 ? STRESS_SCENE : LEVEL_SCENE;
+        else if (strcmp(argument, "--hz") == 0)        config.time_step = 1.0f / (float)atof(value);
+        else if (strcmp(argument, "--threads") == 0)   config.threads = atoi(value);
+        else if (strcmp(argument, "--sleep") == 0)     config.sleeping = strcmp(value, "off") != 0;
+        else if (strcmp(argument, "--lod") == 0)       config.ai_lod = strcmp(value, "off") != 0;
+        else if (strcmp(argument, "--replay") == 0)    config.replay_path = value;
+        else if (strcmp(argument, "--rewind") == 0)    config.rewind_ticks = atoi(value);
+        else if (strcmp(argument, "--churn") == 0)     config.churn = atoi(value);
+        else if (strcmp(argument, "--bench") == 0 && strcmp(value, "overlap") == 0)    config.bench_overlap = true;
+        else if (strcmp(argument, "--bench") == 0 && strcmp(value, "ai") == 0)         config.bench_ai = true;
+        else if (strcmp(argument, "--check") == 0 && strcmp(value, "tunnelling") == 0) config.check_tunnelling = true;
+        else
+        {
+            LOG("Unknown argument " << argument);
+            return false;
+        }
+
+        i++;
+    }
+
+    return config.ticks > 0 && config.time_step > 0.0f && config.threads >= 0 && config.rewind_ticks >= 0 && config.churn >= 0;
+}
+
+// ––––– OVERLAP BENCHMARK ––––– //
+// One player-sized box against N enemy-sized boxes scattered around it, three
+// ways: Entity::check_collision one entity at a time (what the collision
+// passes used to do), the scalar kernel, and the SIMD kernel. All three have
+// to agree on the hit count for the timings to mean anything.
+template <typename Test>
+double time_per_box(int box_count, Test test)
+{
+    int repeats = (1 << 24) / box_count;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; i++) test();
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / ((double)repeats * box_count);
+}
+
+int run_overlap_benchmark()
+{
+    LOG("Boxes     Entity ns/box  Scalar ns/box  SIMD ns/box  Speedup  Hits");
+
+    std::mt19937 rng(0);
+
+    for (int box_count = 16; box_count <= 65536; box_count *= 4)
+    {
+        BodyStore bodies;
+        bodies.reserve(box_count + 1);
+
+        Entity  query;
+        Entity* boxes = new Entity[box_count];
+
+        query.attach_body(&bodies, bodies.create());
+        query.set_width(0.9f);
+        query.set_height(0.9f);
+
+        // Over an 8x8 area, about one box in twenty touches the query
+        std::uniform_real_distribution<float> coordinate(-4.0f, 4.0f);
+
+        for (int i = 0; i < box_count; i++)
+        {
+            boxes[i].attach_body(&bodies, bodies.create());
+            boxes[i].set_position(glm::vec3(coordinate(rng), coordinate(rng), 0.0f));
+        }
+
+        std::vector<int> hits(box_count);
+        int entity_hits = 0, scalar_hits = 0, simd_hits = 0;
+
+        double entity_ns = time_per_box(box_count, [&]() {
+            entity_hits = 0;
+            for (int i = 0; i < box_count; i++) entity_hits += query.check_collision(&boxes[i]) ? 1 : 0;
+        });
+
+        double scalar_ns = time_per_box(box_count, [&]() {
+            scalar_hits = overlap_boxes_scalar(0.0f, 0.0f, 0.45f, 0.45f, &bodies.position_x[1], &bodies.position_y[1],
+                                               &bodies.half_width[1], &bodies.half_height[1], &bodies.active[1], box_count, hits.data());
+        });
+
+        double simd_ns = time_per_box(box_count, [&]() {
+            simd_hits = overlap_boxes(0.0f, 0.0f, 0.45f, 0.45f, &bodies.position_x[1], &bodies.position_y[1],
+                                      &bodies.half_width[1], &bodies.half_height[1], &bodies.active[1], box_count, hits.data());
+        });
+
+        std::cout << std::left;
+        std::cout.width(10); std::cout << box_count;
+        std::cout.width(15); std::cout << entity_ns;
+        std::cout.width(15); std::cout << scalar_ns;
+        std::cout.width(13); std::cout << simd_ns;
+        std::cout.width(9);  std::cout << entity_ns / simd_ns;
+        std::cout << simd_hits << '\n';
+
+        delete[] boxes;
+
+        if (entity_hits != simd_hits || scalar_hits != simd_hits)
+        {
+            LOG("Hit counts disagree: " << entity_hits << " entity, " << scalar_hits << " scalar, " << simd_hits << " SIMD");
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+// ––––– AI BENCHMARK ––––– //
+// The AI pass for N enemies of every type scattered around the player, so
+// each state machine keeps flipping between its states. Once with every
+// enemy working out where the player is by itself, once with the batched
+// perception sweep first, and once with the sweep and then one loop per
+// AIType through its policy, which is what the world does. Each with the
+// types shuffled and with the same enemies grouped by type, as the stress
+// scene now lays them out.
+template <AIType TYPE>
+void think_bucket(Entity* enemies, const std::vector<int>& bucket, const float* distances_squared, const float* offsets_x)
+{
+    int count = (int)bucket.size();
+
+    for (int i = 0; i < count; i++)
+    {
+        int enemy = bucket[i];
+        if (i + AI_PREFETCH_DISTANCE < count) prefetch_for_ai(enemies[bucket[i + AI_PREFETCH_DISTANCE]]);
+
+        Perception perception = { distances_squared[enemy], offsets_x[enemy], 0.0f };
+        enemies[enemy].begin_update<TYPE>(FIXED_TIMESTEP, perception);
+    }
+}
+
+template <size_t... TYPES>
+void think_buckets(Entity* enemies, const std::vector<int>* buckets, const float* distances_squared, const float* offsets_x,
+                   std::index_sequence<TYPES...>)
+{
+    int expand[] = { 0, (think_bucket<(AIType)TYPES>(enemies, buckets[TYPES], distances_squared, offsets_x), 0)... };
+    (void)expand;
+}
+
+int run_ai_benchmark()
+{
+    LOG("Enemies   Order     Per-enemy us/tick  Batched us/tick  Bucketed us/tick  Of which sweep  Speedup");
+
+    for (int run = 0; run < 8; run++)
+    {
+        int  enemy_count = 1000 << (2 * (run / 2));
+        bool grouped     = run % 2 == 1;
+        std::mt19937 rng(enemy_count);
+
+        BodyStore bodies;
+        bodies.reserve(enemy_count + 1);
+
+        Entity  player;
+        Entity* enemies = new Entity[enemy_count];
+        player.attach_body(&bodies, bodies.create());
+
+        std::uniform_real_distribution<float> coordinate(-4.0f, 4.0f);
+
+        for (int i = 0; i < enemy_count; i++)
+        {
+            AIType ai_type = (AIType)(grouped ? (i * AI_TYPE_COUNT) / enemy_count : rng() % AI_TYPE_COUNT);
+            float x = coordinate(rng);
+
+            enemies[i].attach_body(&bodies, bodies.create());
+            enemies[i].set_entity_type(ENEMY);
+            enemies[i].set_ai_type(ai_type);
+            enemies[i].set_ai_state(ai_type == PATROLLER ? PATROL : IDLE);
+            enemies[i].set_position(glm::vec3(x, coordinate(rng), 0.0f));
+            enemies[i].set_speed(0.5f);
+            enemies[i].set_jumping_power(3.0f);
+            enemies[i].pt1 = x + 1.0f;
+            enemies[i].pt2 = x - 1.0f;
+        }
+
+        std::vector<float> distances_squared(enemy_count);
+        std::vector<float> offsets_x(enemy_count);
+        int repeats = (1 << 22) / enemy_count;
+
+        std::vector<int> buckets[AI_TYPE_COUNT];
+        for (int i = 0; i < enemy_count; i++) buckets[enemies[i].get_ai_type()].push_back(i);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int repeat = 0; repeat < repeats; repeat++)
+        {
+            for (int i = 0; i < enemy_count; i++) enemies[i].begin_update(FIXED_TIMESTEP, enemies[i].perceive(&player));
+        }
+        std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+        for (int repeat = 0; repeat < repeats; repeat++)
+        {
+            perceive_point(bodies.position_x[0], bodies.position_y[0], &bodies.position_x[1], &bodies.position_y[1], enemy_count,
+                           distances_squared.data(), offsets_x.data());
+
+            for (int i = 0; i < enemy_count; i++)
+            {
+                Perception perception = { distances_squared[i], offsets_x[i], 0.0f };
+                enemies[i].begin_update(FIXED_TIMESTEP, perception);
+            }
+        }
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        for (int repeat = 0; repeat < repeats; repeat++)
+        {
+            perceive_point(bodies.position_x[0], bodies.position_y[0], &bodies.position_x[1], &bodies.position_y[1], enemy_count,
+                           distances_squared.data(), offsets_x.data());
+            think_buckets(enemies, buckets, distances_squared.data(), offsets_x.data(), std::make_index_sequence<AI_TYPE_COUNT>());
+        }
+        std::chrono::steady_clock::time_point bucketed_end = std::chrono::steady_clock::now();
+        for (int repeat = 0; repeat < repeats; repeat++)
+        {
+            perceive_point(bodies.position_x[0], bodies.position_y[0], &bodies.position_x[1], &bodies.position_y[1], enemy_count,
+                           distances_squared.data(), offsets_x.data());
+        }
+        std::chrono::steady_clock::time_point sweep_end = std::chrono::steady_clock::now();
+
+        double per_enemy_us = std::chrono::duration<double, std::micro>(middle - start).count() / repeats;
+        double batched_us   = std::chrono::duration<double, std::micro>(end - middle).count() / repeats;
+        double bucketed_us  = std::chrono::duration<double, std::micro>(bucketed_end - end).count() / repeats;
+        double sweep_us     = std::chrono::duration<double, std::micro>(sweep_end - bucketed_end).count() / repeats;
+
+        std::cout << std::left;
+        std::cout.width(10); std::cout << enemy_count;
+        std::cout.width(10); std::cout << (grouped ? "grouped" : "mixed");
+        std::cout.width(19); std::cout << per_enemy_us;
+        std::cout.width(17); std::cout << batched_us;
+        std::cout.width(18); std::cout << bucketed_us;
+        std::cout.width(16); std::cout << sweep_us;
+        std::cout << per_enemy_us / bucketed_us << '\n';
+
+        delete[] enemies;
+    }
+
+    return 0;
+}
+
+// ––––– TUNNELLING CHECK ––––– //
+// A player-sized body fired at 0.4 x 1 platforms, sideways and from above, at
+// every combination of step rate and speed below. It has to end up resting
+// against the near face of the first one every time; one step carrying it
+// clean past is exactly what the swept collision is there to stop.
+//
+// With a stack, the platforms are lined up one behind the other along the
+// way the body is moving, more of them than a capped overlap query holds,
+// and added farthest first so the one it has to stop on has the highest id.
+// At the fast rates one step sweeps across all of them.
+#define STACKED_PLATFORMS (2 * StaticMap::MAX_OVERLAPS)
+
+bool fire_at_platforms(float time_step, float speed, bool sideways, int platform_count)
+{
+    StaticMap map;
+    for (int i = platform_count - 1; i >= 0; i--)
+    {
+        if (sideways) map.add_box(0.8f * i, 0.0f, 0.2f, 0.5f);
+        else          map.add_box(0.0f, -1.5f * i, 0.2f, 0.5f);
+    }
+    map.bake(STATIC_MAP_CELL_SIZE);
+
+    BodyStore bodies;
+    Entity mover;
+    mover.attach_body(&bodies, bodies.create());
+    mover.set_entity_type(PLAYER);
+    mover.set_width(0.9f);
+    mover.set_height(0.9f);
+    mover.set_speed(speed);
+    mover.set_acceleration(glm::vec3(0.0f));
+
+    if (sideways)
+    {
+        mover.set_position(glm::vec3(-3.0f, 0.0f, 0.0f));
+        mover.set_movement(glm::vec3(1.0f, 0.0f, 0.0f));
+    }
+    else
+    {
+        mover.set_position(glm::vec3(0.0f, 5.0f, 0.0f));
+        mover.set_movement(glm::vec3(0.0f));
+        mover.set_velocity(glm::vec3(0.0f, -speed, 0.0f));
+    }
+
+    // Same phases, in the same order, as World::step
+    for (float time = 0.0f; time < 2.0f; time += time_step)
+    {
+        mover.begin_update(time_step);
+        bodies.integrate_velocity(0, 1, time_step);
+        bodies.integrate_position_y(0, 1, time_step);
+        mover.check_static_collision_y(map);
+        bodies.integrate_position_x(0, 1, time_step);
+        mover.check_static_collision_x(map);
+        mover.end_update();
+    }
+
+    // Stopped short of the first platform, and without any query having had
+    // to drop a box to get there
+    glm::vec3 position = mover.get_position();
+    bool stopped = sideways ? position.x + 0.45f <= -0.2f + 0.001f
+                            : position.y - 0.45f >=  0.5f - 0.001f;
+    return stopped && map.get_overflow_count() == 0;
+}
+
+int run_tunnelling_check()
+{
+    const float rates[]  = { 60.0f, 30.0f, 15.0f, 10.0f };
+    const float speeds[] = { 1.0f, 10.0f, 100.0f, 1000.0f };
+
+    LOG("Hz    Speed   Sideways  From above  Stack sideways  Stack from above");
+
+    bool all_passed = true;
+
+    for (float rate : rates)
+    {
+        for (float speed : speeds)
+        {
+            bool sideways         = fire_at_platforms(1.0f / rate, speed, true, 1);
+            bool from_above       = fire_at_platforms(1.0f / rate, speed, false, 1);
+            bool stack_sideways   = fire_at_platforms(1.0f / rate, speed, true, STACKED_PLATFORMS);
+            bool stack_from_above = fire_at_platforms(1.0f / rate, speed, false, STACKED_PLATFORMS);
+            all_passed = all_passed && sideways && from_above && stack_sideways && stack_from_above;
+
+            std::cout << std::left;
+            std::cout.width(6);  std::cout << rate;
+            std::cout.width(8);  std::cout << speed;
+            std::cout.width(10); std::cout << (sideways ? "stopped" : "THROUGH");
+            std::cout.width(12); std::cout << (from_above ? "stopped" : "THROUGH");
+            std::cout.width(16); std::cout << (stack_sideways ? "stopped" : "THROUGH");
+            std::cout << (stack_from_above ? "stopped" : "THROUGH") << '\n';
+        }
+    }
+
+    LOG((all_passed ? "All stopped" : "Tunnelling detected"));
+    return all_passed ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
+{
+    DriverConfig config;
+    if (!parse_arguments(argc, argv, config))
+    {
+        LOG("Usage: Headless [--ticks N] [--hz N] [--threads N] [--sleep on|off] [--lod on|off] [--scene level|stress] [--platforms N] [--enemies N] [--seed N] "
+            "[--replay FILE] [--rewind N] [--churn N] [--bench overlap|ai] [--check tunnelling]");
+        return 1;
+    }
+
+    if (config.bench_overlap)    return run_overlap_benchmark();
+    if (config.bench_ai)         return run_ai_benchmark();
+    if (config.check_tunnelling) return run_tunnelling_check();
+
+    // A replay brings its own scene, rate and length
+    InputLog replay;
+    if (config.replay_path != NULL)
+    {
+        if (!replay.load(config.replay_path))
+        {
+            LOG("Unable to read replay " << config.replay_path);
+            return 1;
+        }
+
+        config.scene     = replay.get_scene();
+        config.time_step = replay.get_time_step();
+        config.ticks     = replay.get_tick_count();
+        if (config.ticks == 0) return 0;
+    }
+
+    World world(config.time_step, config.threads);
+    world.initialise(config.scene);
+    world.set_sleeping_enabled(config.sleeping);
+    world.set_ai_lod_enabled(config.ai_lod);
+
+    // A recorded session may have rewound, which only replays with history
+    world.set_rewind_enabled(config.rewind_ticks > 0 || config.replay_path != NULL);
+
+    const GameState& state = world.get_state();
+    const EntityPool& enemy_pool = world.get_enemy_pool();
+    LOG("Scene: " << state.platform_count << " platforms, " << enemy_pool.get_live_count() << " enemies, "
+                  << world.get_thread_count() << " threads");
+
+    // Churn replaces enemies picked from a fixed sequence, so a run is the
+    // same every time; a replay brings its own scene and never churns
+    int churn = config.replay_path != NULL ? 0 : config.churn;
+    std::mt19937 churn_rng(config.scene.seed);
+    double churn_microseconds = 0.0;
+
+    // The clock moves one fixed step per frame, so the world goes through the
+    // exact same accumulator path the game does
+    ManualClock clock;
+    std::vector<double> tick_microseconds;
+    tick_microseconds.reserve(config.ticks + 1);
+
+    size_t warm_up_allocations  = 0;
+    size_t steady_allocations   = 0;
+    size_t steady_ticks         = 0;
+    int    diverged_tick        = -1;
+
+    // The state after every tick, the start included, to check rewinds against
+    std::vector<unsigned long long> tick_hashes;
+    if (config.rewind_ticks > 0)
+    {
+        tick_hashes.reserve(config.ticks + 1);
+        tick_hashes.push_back(world.hash_state());
+    }
+
+    while ((int)tick_microseconds.size() < config.ticks)
+    {
+        int tick = (int)tick_microseconds.size();
+        if (config.replay_path != NULL) world.set_input(replay.get_input(tick));
+
+        clock.advance(config.time_step);
+
+        size_t allocations_before = g_heap_allocations;
+
+        if (churn > 0 && enemy_pool.get_live_count() > 0)
+        {
+            std::chrono::steady_clock::time_point churn_start = std::chrono::steady_clock::now();
+            for (int i = 0; i < churn && enemy_pool.get_live_count() > 0; i++)
+            {
+                int slot = enemy_pool.get_live()[churn_rng() % (unsigned int)enemy_pool.get_live_count()];
+                world.despawn_enemy(state.enemies[slot].get_handle());
+            }
+            for (int i = 0; i < churn; i++)
+            {
+                float x = -10.0f + (float)(churn_rng() % 2000u) / 100.0f;
+                world.spawn_enemy((AIType)(churn_rng() % (unsigned int)AI_TYPE_COUNT), glm::vec3(x, 0.0f, 0.0f));
+            }
+            std::chrono::steady_clock::time_point churn_end = std::chrono::steady_clock::now();
+            churn_microseconds += std::chrono::duration<double, std::micro>(churn_end - churn_start).count();
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        int steps = world.update(&clock);
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+        size_t allocations = g_heap_allocations - allocations_before;
+        if (tick_microseconds.size() < WARM_UP_TICKS) warm_up_allocations += allocations;
+        else
+        {
+            steady_allocations += allocations;
+            steady_ticks += steps;
+        }
+
+        if (steps == 0) continue;
+
+        // Hashing stays outside the timed region
+        if (config.replay_path != NULL && diverged_tick < 0 && tick < replay.get_hash_count() &&
+            world.hash_state() != replay.get_hash(tick))
+        {
+            diverged_tick = tick;
+        }
+        if (config.rewind_ticks > 0) tick_hashes.insert(tick_hashes.end(), steps, world.hash_state());
+
+        double microseconds = std::chrono::duration<double, std::micro>(end - start).count() / steps;
+        for (int i = 0; i < steps; i++) tick_microseconds.push_back(microseconds);
+    }
+
+    double total = 0.0;
+    for (double microseconds : tick_microseconds) total += microseconds;
+
+    std::vector<double> sorted = tick_microseconds;
+    std::sort(sorted.begin(), sorted.end());
+
+    LOG("Ticks:      " << sorted.size());
+    LOG("Total:      " << total / 1000.0 << " ms");
+    LOG("Mean:       " << total / sorted.size() << " us/tick");
+    LOG("Median:     " << sorted[sorted.size() / 2] << " us/tick");
+    LOG("99th:       " << sorted[(sorted.size() * 99) / 100] << " us/tick");
+    LOG("Max:        " << sorted.back() << " us/tick");
+    LOG("Heap:       " << warm_up_allocations << " allocations in the first " << WARM_UP_TICKS << " ticks, "
+                       << steady_allocations << " in the " << steady_ticks << " after");
+
+    glm::vec3 player_position = state.player->get_position();
+    LOG("Player:     (" << player_position.x << ", " << player_position.y << ")");
+    LOG("Awake:      " << world.get_awake_enemy_count() << " of " << enemy_pool.get_live_count() << " enemies, "
+                       << world.get_thinking_enemy_count() << " thinking on the last tick");
+    if (churn > 0)
+    {
+        LOG("Churn:      " << churn << " despawned and " << churn << " spawned before every tick, "
+                           << churn_microseconds * 1000.0 / ((double)tick_microseconds.size() * churn * 2) << " ns each");
+    }
+    const FlowField& flow_field = world.get_flow_field();
+    LOG("Flow:       " << flow_field.get_walkable_count() << " walkable of " << flow_field.get_cell_count() << " cells, "
+                       << flow_field.get_rebuild_count() << " searches");
+    LOG("Overlaps:   " << world.get_static_map().get_overflow_count() << " static overlaps dropped past " << StaticMap::MAX_OVERLAPS << " boxes");
+    LOG("State:      " << std::hex << world.hash_state() << std::dec);
+
+    if (config.replay_path != NULL)
+    {
+        LOG("Replay:     " << replay.get_tick_count() << " ticks from " << replay.get_encoded_bytes() << " bytes of input");
+        if (diverged_tick < 0) LOG("Hashes:     all " << replay.get_hash_count() << " match");
+        else                   LOG("Hashes:     diverged at tick " << diverged_tick);
+    }
+    LOG("Outcome:    " << (state.win ? "win" : state.lose ? "lose" : "running") << ", " << state.enemy_slain << " slain");
+
+    // ––––– REWIND ––––– //
+    // Hold rewind for as many ticks as asked, or as the history goes back,
+    // and the world has to land on exactly the state it had back then
+    if (config.rewind_ticks > 0)
+    {
+        int frames = world.get_rewind_frame_count();
+        int rewind_ticks = std::min(config.rewind_ticks, frames);
+
+        LOG("Rewind:     " << frames << " ticks of history in " << world.get_rewind_bytes() << " bytes, "
+                           << world.get_snapshot_bytes() << " bytes per snapshot");
+
+        double rewind_microseconds = 0.0;
+        world.set_input(INPUT_REWIND);
+
+        for (int i = 0; i < rewind_ticks; i++)
+        {
+            clock.advance(config.time_step);
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            world.update(&clock);
+            std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+            rewind_microseconds += std::chrono::duration<double, std::micro>(end - start).count();
+        }
+
+        int target_tick = (int)tick_hashes.size() - 1 - rewind_ticks;
+        bool matches = world.hash_state() == tick_hashes[target_tick];
+
+        LOG("Restore:    " << rewind_microseconds / std::max(rewind_ticks, 1) << " us/tick over " << rewind_ticks << " ticks");
+        LOG("Rewound:    to tick " << target_tick << ", state " << (matches ? "matches" : "DIFFERS"));
+        if (!matches) return 1;
+    }
+
+    world.shutdown();
+    return 0;
+}
@@ -9,12 +9,12 @@
 **/
 
 #define GL_SILENCE_DEPRECATION
-#define STB_IMAGE_IMPLEMENTATION
 #define LOG(argument) std::cout << argument << '\n'
 #define GL_GLEXT_PROTOTYPES 1
-#define FIXED_TIMESTEP 0.0166666f
-#define PLATFORM_COUNT 18
-#define ENEMY_COUNT 3
+#define FIXED_TIMESTEP 0.0166666f  // 60 Hz unless --hz says otherwise
+#define ASSET_WORKER_COUNT 0       // one per hardware thread, capped at the number of assets
+#define ASSET_UPLOADS_PER_FRAME 1
+#define FRAME_ARENA_BYTES 65536    // a busy frame's baked vertices and sorted instances
 
 #ifdef _WINDOWS
 #include <GL/glew.h>
@@ -26,22 +26,20 @@
 #include "glm/mat4x4.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "ShaderProgram.h"
-#include "stb_image.h"
 #include "cmath"
+#include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include <vector>
+#include "AssetLoader.h"
 #include "Entity.h"
-
-// ––––– STRUCTS AND ENUMS ––––– //
-struct GameState
-{
-    Entity* player;
-    Entity* platforms;
-    Entity* enemies;
-
-    Mix_Music* bgm;
-    Mix_Chunk* jump_sfx;
-};
+#include "FrameArena.h"
+#include "InputLog.h"
+#include "ResourceCache.h"
+#include "SpriteBatch.h"
+#include "SpriteInstances.h"
+#include "TextureAtlas.h"
+#include "World.h"
 
 // ––––– CONSTANTS ––––– //
 const int   WINDOW_WIDTH = 640,
@@ -58,13 +56,13 @@ const int   VIEWPORT_X = 0,
             VIEWPORT_HEIGHT = WINDOW_HEIGHT;
 
 const char  V_SHADER_PATH[] = "shaders/vertex_textured.glsl",
-            F_SHADER_PATH[] = "shaders/fragment_textured.glsl";
+            F_SHADER_PATH[] = "shaders/fragment_textured.glsl",
+            V_INSTANCED_SHADER_PATH[] = "shaders/vertex_instanced.glsl";
 
 const float MILLISECONDS_IN_SECOND  = 1000.0;
-const char  SPRITESHEET_FILEPATH[]  = "assets/goku.png",
-            PLATFORM_FILEPATH[]     = "assets/wood.png",
-            ENEMY_FILEPATH[]        = "assets/dragonball.png",
-            FONT_FILEPATH[] = "assets/font1.png";
+// Every sheet and the font, packed by AtlasPacker from assets/atlas.txt
+const char  ATLAS_FILEPATH[]          = "assets/atlas.tga",
+            ATLAS_MANIFEST_FILEPATH[] = "assets/atlas.bin";
 
 
 const char  BGM_FILEPATH[]          = "assets/audio/wind.mp3",
@@ -72,10 +70,6 @@ const char  BGM_FILEPATH[]          = "assets/audio/wind.mp3",
 //I can't hear audio but it is not listed as a req
 const int   LOOP_FOREVER     = 0;  // -1 means loop forever in Mix_PlayMusic; 0 means play once and loop zero times
 
-const int NUMBER_OF_TEXTURES = 1;
-const GLint LEVEL_OF_DETAIL  = 0;
-const GLint TEXTURE_BORDER   = 0;
-
 // BGM
 const int   CD_QUAL_FREQ    = 44100,  // CD quality
             AUDIO_CHAN_AMT  = 2,      // Stereo
@@ -88,15 +82,13 @@ const int   PLAY_ONCE   = 0,
             MILS_IN_SEC = 1000,
             ALL_SFX_CHN = -1;
 
-const int FONTBANK_SIZE = 16;
-
-bool win = false;
-bool lose = false;
-
-int enemy_slain = 0;
-
 // ––––– GLOBAL VARIABLES ––––– //
-GameState g_game_state;
+World g_world(FIXED_TIMESTEP);
+SteadyClock g_clock;
+
+// --record path: log every tick's input and state hash, for the headless replay
+InputLog    g_input_log;
+const char* g_record_path = NULL;
 
 SDL_Window* g_display_window;
 bool g_game_is_running = true;
@@ -104,42 +96,65 @@ bool g_game_is_running = true;
 ShaderProgram g_shader_program;
 glm::mat4 g_view_matrix, g_projection_matrix;
 
-float g_previous_ticks = 0.0f;
-float g_time_accumulator = 0.0f;
-
-// Audio
-Mix_Music* g_music;
-Mix_Chunk* g_bouncing_sfx;
+// Entities are drawn as instances of one quad, one call per texture; text
+// goes through the batch, which is also where the sprites go without
+// instancing. Both are flushed at the end of render().
+ShaderProgram   g_instanced_program;
+SpriteInstances g_sprite_instances;
+SpriteBatch     g_sprite_batch;
+
+// What the renderers need only until it's uploaded; reset every frame
+FrameArena g_frame_arena(FRAME_ARENA_BYTES);
+
+// Every texture and sound, loaded once and kept until shutdown. They're
+// decoded in the background while the game starts up, and land in the cache
+// over the first few frames.
+ResourceCache g_resources;
+AssetLoader   g_loader;
+int           g_steady_frame_loads = 0;  // loads during a frame after the assets landed, which should stay 0
+
+// Everything is drawn from the one texture, so no draw ever switches it.
+// Until it's landed that's a placeholder, and every sprite is a flat block.
+TextureAtlas   g_atlas;
+int            g_atlas_request;
+ResourceHandle g_placeholder_texture;
+GLuint         g_atlas_texture_id;
+int          g_font_frame;  // the font's first glyph in the atlas; the rest follow in ASCII order
+
+// Audio, silent until each has landed
+int  g_music_request;
+int  g_bouncing_sfx_request;
+bool g_music_started = false;
+
+// How long the game took to show something, and to have everything
+double g_first_frame_seconds = -1.0;
+double g_all_landed_seconds  = -1.0;
 
 // ———— GENERAL FUNCTIONS ———— //
-GLuint load_texture(const char* filepath)
+// The first frame of a sheet in the atlas, which the game can't run without
+int find_sheet_frame(const char* name)
 {
-    int width, height, number_of_components;
-    unsigned char* image = stbi_load(filepath, &width, &height, &number_of_components, STBI_rgb_alpha);
-
-    if (image == NULL)
+    int region = g_atlas.find_region(name);
+    if (region < 0)
     {
-        LOG("Unable to load image. Make sure the path is correct.");
+        LOG("The atlas has no \"" << name << "\" sheet. Make sure AtlasPacker ran.");
         assert(false);
+        return 0;
     }
 
-    GLuint textureID;
-    glGenTextures(NUMBER_OF_TEXTURES, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, LEVEL_OF_DETAIL, GL_RGBA, width, height, TEXTURE_BORDER, GL_RGBA, GL_UNSIGNED_BYTE, image);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    return g_atlas.get_region(region).first_frame;
+}
 
-    stbi_image_free(image);
+void set_atlas_texture(GLuint texture_id)
+{
+    GameState& state = g_world.get_state();
+    g_atlas_texture_id = texture_id;
 
-    return textureID;
+    for (int i = 0; i < state.platform_count; i++) state.platforms[i].m_texture_id = texture_id;
+    for (int i = 0; i < state.enemy_count; i++)    state.enemies[i].m_texture_id   = texture_id;
+    state.player->m_texture_id = texture_id;
 }
 
-
 void initialise()
 {
     // Initialising both the video AND audio subsystems
@@ -156,6 +171,16 @@ void initialise()
 #ifdef _WINDOWS
     glewInit();
 #endif
+    // ––––– ASSETS ––––– //
+    // The loading starts first so it runs under everything else here. Audio
+    // opens before anything lands, since sounds are decoded into its format.
+    Mix_OpenAudio(CD_QUAL_FREQ, MIX_DEFAULT_FORMAT, AUDIO_CHAN_AMT, AUDIO_BUFF_SIZE);
+
+    g_atlas_request        = g_loader.request(ATLAS_FILEPATH, ASSET_TEXTURE);
+    g_music_request        = g_loader.request(BGM_FILEPATH, ASSET_MUSIC);
+    g_bouncing_sfx_request = g_loader.request(BOUNCING_SFX_FILEPATH, ASSET_SOUND);
+    g_loader.start(ASSET_WORKER_COUNT);
+
     // ––––– VIDEO SETUP ––––– //
     glViewport(VIEWPORT_X, VIEWPORT_Y, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
 
@@ -167,134 +192,47 @@ void initialise()
     g_shader_program.set_projection_matrix(g_projection_matrix);
     g_shader_program.set_view_matrix(g_view_matrix);
 
+    g_instanced_program.load(V_INSTANCED_SHADER_PATH, F_SHADER_PATH);
+    g_instanced_program.set_projection_matrix(g_projection_matrix);
+    g_instanced_program.set_view_matrix(g_view_matrix);
+
+    if (!g_atlas.load(ATLAS_MANIFEST_FILEPATH))
+    {
+        LOG("Unable to load the atlas manifest. Make sure AtlasPacker ran.");
+        assert(false);
+    }
+
+    // The manifest is a few kilobytes and every frame needs it, so it isn't
+    // worth a trip through the loader. The texture is, and in the meantime
+    // everything is drawn from one opaque white texel.
+    const unsigned char PLACEHOLDER_PIXEL[] = { 255, 255, 255, 255 };
+    g_placeholder_texture = g_resources.create_texture("placeholder", PLACEHOLDER_PIXEL, 1, 1);
+    g_font_frame = find_sheet_frame("font");
+
     glUseProgram(g_shader_program.get_program_id());
+    g_sprite_instances.initialise(&g_instanced_program, g_atlas.get_frames(), g_atlas.get_frame_count());
+    g_sprite_batch.initialise();
 
     glClearColor(BG_RED, BG_BLUE, BG_GREEN, BG_OPACITY);
 
   
 
-    // ––––– PLATFORMS ––––– //
-    GLuint platform_texture_id = load_texture(PLATFORM_FILEPATH);
-
-    g_game_state.platforms = new Entity[PLATFORM_COUNT];
+    // ––––– WORLD ––––– //
+    g_world.initialise(SceneConfig());
+    g_world.set_rewind_enabled(true);
+    GameState& state = g_world.get_state();
 
-    g_game_state.platforms[PLATFORM_COUNT - 1].m_texture_id = platform_texture_id;
-    g_game_state.platforms[PLATFORM_COUNT - 1].set_position(glm::vec3(-5.0f, -2.35f, 0.0f));
-    g_game_state.platforms[PLATFORM_COUNT - 1].set_width(0.4f);
-    g_game_state.platforms[PLATFORM_COUNT - 1].update(0.0f, NULL, NULL, 0);
+    // Every entity draws from the atlas, each from its own sheet in it, once
+    // it's landed
+    int platform_frame = find_sheet_frame("platform");
+    int player_frame   = find_sheet_frame("player");
+    int enemy_frame    = find_sheet_frame("enemy");
 
-    for (int i = 0; i < PLATFORM_COUNT - 2; i++)
-    {
-        g_game_state.platforms[i].m_texture_id = platform_texture_id;
-        g_game_state.platforms[i].set_position(glm::vec3(i-5.0f, -3.0f, 0.0f));
-        g_game_state.platforms[i].set_width(0.4f);
-        g_game_state.platforms[i].update(0.0f, NULL, NULL, 0);
-    }
+    for (int i = 0; i < state.platform_count; i++) state.platforms[i].m_sheet_frame = platform_frame;
+    for (int i = 0; i < state.enemy_count; i++)    state.enemies[i].m_sheet_frame   = enemy_frame;
+    state.player->m_sheet_frame = player_frame;
 
-    g_game_state.platforms[PLATFORM_COUNT - 2].m_texture_id = platform_texture_id;
-    g_game_state.platforms[PLATFORM_COUNT - 2].set_position(glm::vec3(5.0f, -2.5f, 0.0f));
-    g_game_state.platforms[PLATFORM_COUNT - 2].set_width(0.4f);
-    g_game_state.platforms[PLATFORM_COUNT - 2].update(0.0f, NULL, NULL, 0);
-
-    g_game_state.platforms[PLATFORM_COUNT - 3].m_texture_id = platform_texture_id;
-    g_game_state.platforms[PLATFORM_COUNT - 3].set_position(glm::vec3(0.0f, -0.0f, 0.0f));
-    g_game_state.platforms[PLATFORM_COUNT - 3].set_width(0.4f);
-    g_game_state.platforms[PLATFORM_COUNT - 3].update(0.0f, NULL, NULL, 0);
-
-    g_game_state.platforms[PLATFORM_COUNT - 4].m_texture_id = platform_texture_id;
-    g_game_state.platforms[PLATFORM_COUNT - 4].set_position(glm::vec3(1.0f, -0.0f, 0.0f));
-    g_game_state.platforms[PLATFORM_COUNT - 4].set_width(0.4f);
-    g_game_state.platforms[PLATFORM_COUNT - 4].update(0.0f, NULL, NULL, 0);
-
-    g_game_state.platforms[PLATFORM_COUNT - 5].m_texture_id = platform_texture_id;
-    g_game_state.platforms[PLATFORM_COUNT - 5].set_position(glm::vec3(2.0f, -2.0f, 0.0f));
-    g_game_state.platforms[PLATFORM_COUNT - 5].set_width(0.4f);
-    g_game_state.platforms[PLATFORM_COUNT - 5].update(0.0f, NULL, NULL, 0);
-
-    g_game_state.platforms[PLATFORM_COUNT - 6].m_texture_id = platform_texture_id;
-    g_game_state.platforms[PLATFORM_COUNT - 6].set_position(glm::vec3(3.0f, -1.0f, 0.0f));
-    g_game_state.platforms[PLATFORM_COUNT - 6].set_width(0.4f);
-    g_game_state.platforms[PLATFORM_COUNT - 6].update(0.0f, NULL, NULL, 0);
-
-    g_game_state.platforms[PLATFORM_COUNT - 7].m_texture_id = platform_texture_id;
-    g_game_state.platforms[PLATFORM_COUNT - 7].set_position(glm::vec3(-2.0f, -1.0f, 0.0f));
-    g_game_state.platforms[PLATFORM_COUNT - 7].set_width(0.4f);
-    g_game_state.platforms[PLATFORM_COUNT - 7].update(0.0f, NULL, NULL, 0);
-
-    g_game_state.platforms[PLATFORM_COUNT - 8].m_texture_id = platform_texture_id;
-    g_game_state.platforms[PLATFORM_COUNT - 8].set_position(glm::vec3(-2.0f, -1.0f, 0.0f));
-    g_game_state.platforms[PLATFORM_COUNT - 8].set_width(0.4f);
-    g_game_state.platforms[PLATFORM_COUNT - 8].update(0.0f, NULL, NULL, 0);
-
-    // ––––– PLAYER (GEORGE) ––––– //
-    // Existing
-    g_game_state.player = new Entity();
-    g_game_state.player->set_entity_type(PLAYER);
-    g_game_state.player->set_position(glm::vec3(2.0f, 2.0f, 0.0f));
-    g_game_state.player->set_movement(glm::vec3(0.0f));
-    g_game_state.player->set_speed(1.0f);
-    g_game_state.player->set_acceleration(glm::vec3(0.0f, -4.905f, 0.0f));
-    g_game_state.player->m_texture_id = load_texture(SPRITESHEET_FILEPATH);
-
-    // Walking
-    // Walking
-    g_game_state.player->m_walking[g_game_state.player->LEFT] = new int[3] { 3, 4, 5 };
-    g_game_state.player->m_walking[g_game_state.player->RIGHT] = new int[3] { 6, 7, 8 };
-    g_game_state.player->m_walking[g_game_state.player->UP] = new int[3] { 9, 10, 11 };
-    g_game_state.player->m_walking[g_game_state.player->DOWN] = new int[3] { 0, 1, 2 };
-
-    g_game_state.player->m_animation_indices = g_game_state.player->m_walking[g_game_state.player->RIGHT];  // start George looking right
-    g_game_state.player->m_animation_frames = 3;
-    g_game_state.player->m_animation_index = 0;
-    g_game_state.player->m_animation_time = 0.0f;
-    g_game_state.player->m_animation_cols = 3;
-    g_game_state.player->m_animation_rows = 4;
-    g_game_state.player->set_height(0.9f);
-    g_game_state.player->set_width(0.9f);
-
-    // Jumping
-    g_game_state.player->set_jumping_power(4.0f);
-
-    // ––––– ENEMY (SOPHIE) ––––– //
-    GLuint enemy_texture_id = load_texture(ENEMY_FILEPATH);
-
-    g_game_state.enemies = new Entity[ENEMY_COUNT];
-    g_game_state.enemies[0].set_entity_type(ENEMY);
-    g_game_state.enemies[0].set_ai_type(RUNNER);
-    g_game_state.enemies[0].set_ai_state(IDLE);
-    g_game_state.enemies[0].m_texture_id = enemy_texture_id;
-    g_game_state.enemies[0].set_position(glm::vec3(1.5f, 0.0f, 0.0f));
-    g_game_state.enemies[0].set_movement(glm::vec3(0.0f));
-    g_game_state.enemies[0].set_speed(0.5f);
-    g_game_state.enemies[0].set_acceleration(glm::vec3(0.0f, -9.81f, 0.0f));
-
-    g_game_state.enemies[1].set_entity_type(ENEMY);
-    g_game_state.enemies[1].set_ai_type(JUMPER);
-    g_game_state.enemies[1].set_jumping_power(3.0f);
-    g_game_state.enemies[1].set_ai_state(IDLE);
-    g_game_state.enemies[1].m_texture_id = enemy_texture_id;
-    g_game_state.enemies[1].set_position(glm::vec3(3.0f, 0.0f, 0.0f));
-    g_game_state.enemies[1].set_movement(glm::vec3(0.0f));
-    g_game_state.enemies[1].set_speed(0.5f);
-    g_game_state.enemies[1].set_acceleration(glm::vec3(0.0f, -1.5f, 0.0f));
-
-    g_game_state.enemies[2].set_entity_type(ENEMY);
-    g_game_state.enemies[2].set_ai_type(PATROLLER);
-    g_game_state.enemies[2].set_ai_state(PATROL);
-    g_game_state.enemies[2].m_texture_id = enemy_texture_id;
-    g_game_state.enemies[2].set_position(glm::vec3(-4.8f, 0.0f, 0.0f));
-    g_game_state.enemies[2].set_movement(glm::vec3(1.0f));
-    g_game_state.enemies[2].set_speed(0.5f);
-    g_game_state.enemies[2].set_acceleration(glm::vec3(0.0f, -9.81f, 0.0f));
-
-    // ––––– AUDIO STUFF ––––– //
-    Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 4096);
-
-    g_game_state.bgm = Mix_LoadMUS(BGM_FILEPATH);
-    Mix_PlayMusic(g_game_state.bgm, -1);
-    Mix_VolumeMusic(MIX_MAX_VOLUME / 4.0f);
-
-    g_game_state.jump_sfx = Mix_LoadWAV(BOUNCING_SFX_FILEPATH);
+    set_atlas_texture(g_resources.get_texture(g_placeholder_texture));
 
     // ––––– GENERAL ––––– //
     glEnable(GL_BLEND);
@@ -303,7 +241,8 @@ void initialise()
 
 void process_input()
 {
-    g_game_state.player->set_movement(glm::vec3(0.0f));
+    GameState& state = g_world.get_state();
+    unsigned char buttons = 0;
 
     SDL_Event event;
     while (SDL_PollEvent(&event))
@@ -323,13 +262,13 @@ void process_input()
                 break;
 
             case SDLK_SPACE:
-                // Jump
-                if (g_game_state.player->m_collided_bottom)
+                // Jump; the world applies it on its next step
+                buttons |= INPUT_JUMP;
+                if (state.player->has_contact(CONTACT_BOTTOM) && g_loader.has_landed(g_bouncing_sfx_request))
                 {
-                    g_game_state.player->m_is_jumping = true;
                     Mix_PlayChannel(
                         NEXT_CHNL,       // using the first channel that is not currently in use...
-                        g_bouncing_sfx,  // ...play this chunk of audio...
+                        g_resources.get_sound(g_loader.get_handle(g_bouncing_sfx_request)),  // ...play this chunk of audio...
                         PLAY_ONCE        // ...once.
                     );
                 }
@@ -351,188 +290,172 @@ void process_input()
 
     const Uint8* key_state = SDL_GetKeyboardState(NULL);
 
-    if (!lose) {
-        if (key_state[SDL_SCANCODE_LEFT])
-        {
-            g_game_state.player->move_left();
-            g_game_state.player->m_animation_indices = g_game_state.player->m_walking[g_game_state.player->LEFT];
-        }
-        else if (key_state[SDL_SCANCODE_RIGHT])
-        {
-            g_game_state.player->move_right();
-            g_game_state.player->m_animation_indices = g_game_state.player->m_walking[g_game_state.player->RIGHT];
-        }
+    if (key_state[SDL_SCANCODE_LEFT])       buttons |= INPUT_LEFT;
+    else if (key_state[SDL_SCANCODE_RIGHT]) buttons |= INPUT_RIGHT;
 
-        // This makes sure that the player can't move faster diagonally
-        if (glm::length(g_game_state.player->get_movement()) > 1.0f)
-        {
-            g_game_state.player->set_movement(glm::normalize(g_game_state.player->get_movement()));
-        }
-    }
+    // Hold R to scrub back through the last few seconds
+    if (key_state[SDL_SCANCODE_R]) buttons |= INPUT_REWIND;
+
+    // Input goes through the world rather than straight onto the player, so
+    // it lands on fixed steps and can be recorded and replayed
+    g_world.set_input(buttons);
 }
 
-void update()
+// Whatever the workers have finished, into the cache and onto the screen
+void land_assets()
 {
-    float ticks = (float)SDL_GetTicks() / MILLISECONDS_IN_SECOND;
-    float delta_time = ticks - g_previous_ticks;
-    g_previous_ticks = ticks;
+    if (g_loader.is_done()) return;
+    if (g_loader.poll(&g_resources, ASSET_UPLOADS_PER_FRAME) == 0) return;
 
-    delta_time += g_time_accumulator;
+    GLuint atlas_texture_id = g_resources.get_texture(g_loader.get_handle(g_atlas_request));
+    if (atlas_texture_id != 0 && atlas_texture_id != g_atlas_texture_id) set_atlas_texture(atlas_texture_id);
 
-    if (delta_time < FIXED_TIMESTEP)
+    Mix_Music* music = g_resources.get_music(g_loader.get_handle(g_music_request));
+    if (music != nullptr && !g_music_started)
     {
-        g_time_accumulator = delta_time;
-        return;
-    }
-
-    while (delta_time >= FIXED_TIMESTEP) {
-        Entity* collidables = new Entity[PLATFORM_COUNT + ENEMY_COUNT];
-
-        for (int i = 0; i < PLATFORM_COUNT; i++) {
-            collidables[i] = g_game_state.platforms[i];
-        }
-
-        for (int i = 0; i < ENEMY_COUNT; i++) {
-            collidables[PLATFORM_COUNT + i] = g_game_state.enemies[i];
-        }
-
-        g_game_state.player->update(FIXED_TIMESTEP, g_game_state.player, collidables, PLATFORM_COUNT + ENEMY_COUNT);
-
-        for (int i = 0; i < ENEMY_COUNT; i++) g_game_state.enemies[i].update(FIXED_TIMESTEP, g_game_state.player, g_game_state.platforms, PLATFORM_COUNT);
-
-        delta_time -= FIXED_TIMESTEP;
+        Mix_PlayMusic(music, -1);
+        Mix_VolumeMusic(MIX_MAX_VOLUME / 4.0f);
+        g_music_started = true;
     }
 
-    Entity* collided = g_game_state.player->collided;
-    if (collided != nullptr) {
-        if (collided->get_entity_type() == ENEMY && (g_game_state.player->left_enemy or g_game_state.player->right_enemy or g_game_state.player->top_enemy))
-        {
-            lose = true;
-        }
-        if (collided->get_entity_type() == ENEMY && g_game_state.player->bottom_enemy)
-        {
-            AIType type = g_game_state.player->collided->get_ai_type();
-            for (int i = 0; i < ENEMY_COUNT; i++) {
-                if (type == g_game_state.enemies[i].get_ai_type()) {
-                    g_game_state.enemies[i].deactivate();
-                    enemy_slain += 1;
-                }
-            }
-        }
-    }
-
-    if (enemy_slain == ENEMY_COUNT && !lose) {
-        win = true;
+    if (g_loader.is_done())
+    {
+        g_all_landed_seconds = g_clock.get_seconds();
+        LOG("Assets:     all " << g_loader.get_request_count() << " landed at " << g_all_landed_seconds * MILLISECONDS_IN_SECOND << " ms");
     }
-
-
-    g_time_accumulator = delta_time;
 }
 
-void draw_text(ShaderProgram* program, GLuint font_texture_id, std::string text, float screen_size, float spacing, glm::vec3 position)
+void update()
 {
-    // Scale the size of the fontbank in the UV-plane
-    // We will use this for spacing and positioning
-    float width = 1.0f / FONTBANK_SIZE;
-    float height = 1.0f / FONTBANK_SIZE;
-
-    // Instead of having a single pair of arrays, we'll have a series of pairs—one for each character
-    // Don't forget to include <vector>!
-    std::vector<float> vertices;
-    std::vector<float> texture_coordinates;
+    g_world.update(&g_clock);
+}
 
+void draw_text(SpriteBatch* batch, GLuint texture_id, const AtlasRect* glyphs, const std::string& text, float screen_size, float spacing, glm::vec3 position)
+{
     // For every character...
     for (int i = 0; i < text.size(); i++) {
-        // 1. Get their index in the spritesheet, as well as their offset (i.e. their position
+        // 1. Get their glyph, by ascii value, as well as their offset (i.e. their position
         //    relative to the whole sentence)
-        int spritesheet_index = (int)text[i];  // ascii value of character
+        const AtlasRect& glyph = glyphs[(unsigned char)text[i]];
         float offset = (screen_size + spacing) * i;
 
-        // 2. Using the spritesheet index, we can calculate our U- and V-coordinates
-        float u_coordinate = (float)(spritesheet_index % FONTBANK_SIZE) / FONTBANK_SIZE;
-        float v_coordinate = (float)(spritesheet_index / FONTBANK_SIZE) / FONTBANK_SIZE;
-
-        // 3. Inset the current pair in both vectors
-        vertices.insert(vertices.end(), {
-            offset + (-0.5f * screen_size), 0.5f * screen_size,
-            offset + (-0.5f * screen_size), -0.5f * screen_size,
-            offset + (0.5f * screen_size), 0.5f * screen_size,
-            offset + (0.5f * screen_size), -0.5f * screen_size,
-            offset + (0.5f * screen_size), 0.5f * screen_size,
-            offset + (-0.5f * screen_size), -0.5f * screen_size,
-            });
-
-        texture_coordinates.insert(texture_coordinates.end(), {
-            u_coordinate, v_coordinate,
-            u_coordinate, v_coordinate + height,
-            u_coordinate + width, v_coordinate,
-            u_coordinate + width, v_coordinate + height,
-            u_coordinate + width, v_coordinate,
-            u_coordinate, v_coordinate + height,
-            });
+        // 2. And hand it to the batch, which draws the whole string at once
+        batch->add(texture_id, position.x + offset, position.y, 0.5f * screen_size, 0.5f * screen_size, glyph);
     }
-
-    // 4. And render all of them using the pairs
-    glm::mat4 model_matrix = glm::mat4(1.0f);
-    model_matrix = glm::translate(model_matrix, position);
-
-    program->set_model_matrix(model_matrix);
-    glUseProgram(program->get_program_id());
-
-    glVertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices.data());
-    glEnableVertexAttribArray(program->get_position_attribute());
-    glVertexAttribPointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, texture_coordinates.data());
-    glEnableVertexAttribArray(program->get_tex_coordinate_attribute());
-
-    glBindTexture(GL_TEXTURE_2D, font_texture_id);
-    glDrawArrays(GL_TRIANGLES, 0, (int)(text.size() * 6));
-
-    glDisableVertexAttribArray(program->get_position_attribute());
-    glDisableVertexAttribArray(program->get_tex_coordinate_attribute());
 }
 
 void render()
 {
     glClear(GL_COLOR_BUFFER_BIT);
 
-    g_game_state.player->render(&g_shader_program);
+    GameState& state = g_world.get_state();
+
+    // The simulation runs at its own rate, so draw everything partway between
+    // its last two steps according to how far the clock is into the next one
+    float interpolation = g_world.get_interpolation();
+
+    state.player->render(&g_sprite_instances, interpolation);
 
-    for (int i = 0; i < PLATFORM_COUNT; i++) g_game_state.platforms[i].render(&g_shader_program);
-    for (int i = 0; i < ENEMY_COUNT; i++)    g_game_state.enemies[i].render(&g_shader_program);
+    // Only the live enemies; dead slots in the pool aren't drawn at all
+    const EntityPool& enemy_pool = g_world.get_enemy_pool();
+    const int* live_enemies = enemy_pool.get_live();
 
-    GLuint g_font_id = load_texture(FONT_FILEPATH);
+    for (int i = 0; i < state.platform_count; i++)             state.platforms[i].render(&g_sprite_instances, interpolation);
+    for (int i = 0; i < enemy_pool.get_live_count(); i++)      state.enemies[live_enemies[i]].render(&g_sprite_instances, interpolation);
 
-    if (win and !lose)
+    // The sprites first, so the text draws over them
+    g_sprite_instances.flush(&g_sprite_batch, &g_frame_arena);
+
+    const AtlasRect* glyphs = g_atlas.get_frames() + g_font_frame;
+
+    if (state.win and !state.lose)
     {
-        draw_text(&g_shader_program, g_font_id, "You Win!", 0.4, 0.01f, glm::vec3(-3.0f, 0.0f, 0));
+        draw_text(&g_sprite_batch, g_atlas_texture_id, glyphs, "You Win!", 0.4, 0.01f, glm::vec3(-3.0f, 0.0f, 0));
     }
 
-    if (lose and !win)
+    if (state.lose and !state.win)
     {
-        draw_text(&g_shader_program, g_font_id, "You Lose!", 0.4, 0.01f, glm::vec3(-3.0f, 0.0f, 0));
+        draw_text(&g_sprite_batch, g_atlas_texture_id, glyphs, "You Lose!", 0.4, 0.01f, glm::vec3(-3.0f, 0.0f, 0));
     }
 
+    g_sprite_batch.flush(&g_shader_program, &g_frame_arena);
+
     SDL_GL_SwapWindow(g_display_window);
 }
 
 void shutdown()
 {
+    LOG("Arena:      " << g_frame_arena.get_peak_bytes() << " bytes peak, " << g_frame_arena.get_capacity() << " capacity, "
+        << g_frame_arena.get_heap_allocations() << " heap allocations");
+    LOG("Resources:  " << g_resources.get_load_count() << " loads, " << g_resources.get_hit_count() << " cache hits, "
+        << g_resources.get_resident_bytes() / 1024 << " KB resident in " << g_resources.get_resident_count() << ", "
+        << g_steady_frame_loads << " loaded after everything landed");
+
+    // Before SDL_Quit, while there's still a context and an audio device to
+    // free them from
+    Mix_HaltMusic();
+    g_loader.shutdown();
+    g_resources.release(g_loader.get_handle(g_music_request));
+    g_resources.release(g_loader.get_handle(g_bouncing_sfx_request));
+    g_resources.release(g_loader.get_handle(g_atlas_request));
+    g_resources.release(g_placeholder_texture);
+    g_resources.unload_all();
+
+    g_sprite_instances.shutdown();
+    g_sprite_batch.shutdown();
     SDL_Quit();
 
-    delete[] g_game_state.platforms;
-    delete   g_game_state.player;
+    if (g_record_path != NULL)
+    {
+        if (g_input_log.save(g_record_path)) LOG("Recorded " << g_input_log.get_tick_count() << " ticks to " << g_record_path);
+        else                                 LOG("Unable to write " << g_record_path);
+    }
+
+    g_world.shutdown();
 }
 
 // ––––– GAME LOOP ––––– //
 int main(int argc, char* argv[])
 {
+    // Weak machines can run the simulation slower, e.g. --hz 30; rendering
+    // still happens every frame and interpolates between steps. --record
+    // writes the session out for Headless --replay.
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (strcmp(argv[i], "--hz") == 0 && atof(argv[i + 1]) > 0.0) g_world.set_time_step(1.0f / (float)atof(argv[i + 1]));
+        if (strcmp(argv[i], "--record") == 0) g_record_path = argv[i + 1];
+    }
+
     initialise();
 
+    if (g_record_path != NULL)
+    {
+        g_input_log.begin(g_world.get_scene(), g_world.get_time_step());
+        g_world.set_recorder(&g_input_log);
+    }
+
     while (g_game_is_running)
     {
+        g_frame_arena.reset();
+
+        bool steady = g_loader.is_done();
+        int loads_before = g_resources.get_load_count();
+
+        land_assets();
         process_input();
         update();
         render();
+
+        if (steady) g_steady_frame_loads += g_resources.get_load_count() - loads_before;
+
+        // The clock has been running since the program started, so this is
+        // everything up to the first frame being on screen
+        if (g_first_frame_seconds < 0.0)
+        {
+            g_first_frame_seconds = g_clock.get_seconds();
+            LOG("First frame: " << g_first_frame_seconds * MILLISECONDS_IN_SECOND << " ms, with "
+                << g_loader.get_landed_count() << " of " << g_loader.get_request_count() << " assets landed");
+        }
     }
 
     shutdown();
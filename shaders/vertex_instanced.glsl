@@ -0,0 +1,27 @@
+// The instanced variant of vertex_textured.glsl: every vertex is a corner of
+// the same unit quad, and every instance says where its sprite is, how big
+// and which entry of the frame table it shows
+attribute vec2 corner;
+attribute vec2 instancePosition;
+attribute vec2 instanceSize;
+attribute float instanceFrame;
+
+uniform mat4 viewMatrix;
+uniform mat4 projectionMatrix;
+
+// The atlas' frames, one texel each: u, v, width, height
+uniform sampler2D frameTable;
+uniform float frameCount;
+
+varying vec2 texCoordVar;
+
+void main()
+{
+    vec4 frame = texture2DLod(frameTable, vec2((instanceFrame + 0.5) / frameCount, 0.5), 0.0);
+
+    // The top of a frame is at v
+    texCoordVar = frame.xy + vec2(corner.x + 0.5, 0.5 - corner.y) * frame.zw;
+
+	vec4 p = viewMatrix * vec4(instancePosition + corner * instanceSize, 0.0, 1.0);
+	gl_Position = projectionMatrix * p;
+}